@@ -33,53 +33,52 @@ const char html_tail1[]      PROGMEM = "</body></html>";
 
 using namespace lsc;
 
+/**
+ *  Pages are built in scratch memory from the request arena, returned when the handler does, rather than on the stack.
+ *  scratch() returns NULL if there is no arena and the heap is exhausted, answered with a 500.
+ */
  void Simple::handleRoot(WebContext* c) {
-  Serial.printf("handleRoot called...\n");
-  char buffer[1000];
+  size_t len = 1000;
+  char* buffer = c->scratch(len);
+  if( buffer == NULL ) {c->send(500,"text/plain","Out of memory"); return;}
   int pos = 0;
-  size_t len = sizeof(buffer);
   pos = formatBuffer_P(buffer,len,pos,html_header1);
   pos = formatBuffer_P(buffer,len,pos,html_title1,"Hello from the application \"Simple\"");
   pos = formatBuffer_P(buffer,len,pos,html_tail1);
-  Serial.printf("   Sending %d bytes\n",strlen(buffer));
   c->send(200,"text/html",buffer);
-  Serial.printf("...handleRoot done\n\n");
+  LOG_INFO("handleRoot sent %d bytes",(int)strlen(buffer));
 }
 
+/**
+ *  The number of args is unbounded, so the page is streamed with a ResponseWriter rather than built in a fixed buffer
+ */
 void Simple::handleDevice(WebContext* c) {
-  Serial.printf("handleDevice called...\n");
-  char buffer[1000];
-  int pos = 0;
-  size_t len = sizeof(buffer);
-  pos = formatBuffer_P(buffer,len,pos,html_header1);
-  pos = formatBuffer_P(buffer,len,pos,html_title1,"Arg Test");
+  ResponseWriter w(c);
+  w.begin(200,TEXT_HTML);
+  w.printf_P(html_header1);
+  w.printf_P(html_title1,"Arg Test");
   int argCount = c->argCount();
   for( int i=0; i<argCount; i++) {
     const String& argName = c->argName(i);
     const String& argVal  = c->arg(i);
-    pos = formatBuffer_P(buffer,len,pos,html_body1,i,argName.c_str(),argVal.c_str());
+    w.printf_P(html_body1,i,argName.c_str(),argVal.c_str());
   }
-  pos = formatBuffer_P(buffer,len,pos,html_tail1);
-  Serial.printf("   sending %d bytes:\n",strlen(buffer));
-  c->send(200,"text/html",buffer);  
-  Serial.printf("...handleDevice done\n");
+  w.printf_P(html_tail1);
+  w.end();
+  LOG_INFO("handleDevice sent %d bytes for %d args",(int)w.bytesWritten(),argCount);
 }
 
 void Simple::handleRequest(WebContext* c) {
-  Serial.printf("handleRequest called...\n");
-  char buffer[1000];
+  size_t len = 1000;
+  char* buffer = c->scratch(len);
+  if( buffer == NULL ) {c->send(500,"text/plain","Out of memory"); return;}
   int pos = 0;
-  size_t len = sizeof(buffer);
   pos = formatBuffer_P(buffer,len,pos,html_header1);
   pos = formatBuffer_P(buffer,len,pos,html_title1,"Request Endpoint Info");
   pos = formatBuffer_P(buffer,len,pos,html_body2,c->client().localIP().toString().c_str(),c->getLocalPort(),c->client().remoteIP().toString().c_str(),c->client().remotePort());
   pos = formatBuffer_P(buffer,len,pos,html_tail1);
   len = strlen(buffer);
-  Serial.printf("   sending %d bytes:\n",strlen(buffer));
   c->send(200,"text/html",buffer);
-  Serial.printf("...handleRequest done\n\n");
+  LOG_INFO("handleRequest sent %d bytes",(int)len);
 }
 
-void Simple::styles(WebContext* c) {
-  c->send_P(200,TEXT_CSS,styles_css);
-}
@@ -33,7 +33,6 @@ class Simple {
   static void handleRoot(WebContext* c);
   static void handleDevice(WebContext* c);
   static void handleRequest(WebContext* c);
-  static void styles(WebContext* c);
   
 };
 
@@ -67,9 +67,11 @@ void setup() {
   ctx.on("/",[](WebContext* c){Simple::handleRoot(c);});
   ctx.on("/device",[](WebContext* c){Simple::handleDevice(c);});
   ctx.on("/request",[](WebContext* c){Simple::handleRequest(c);});
-  ctx.on("/styles.css",[](WebContext* svr){Simple::styles(svr);});
+  ctx.serveStatic_P("/styles.css",styles_css_asset);
+  ctx.enableLog();
 }
 
 void loop() {
      ctx.handleClient();
+     Log.drain();
 }
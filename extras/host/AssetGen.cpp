@@ -0,0 +1,225 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/**
+ *   Build time asset pipeline. Each source file is minified by type, gzip compressed, and written into one
+ *   generated header of PROGMEM arrays with lengths, an FNV-1a content hash and a ProgmemAsset describing both
+ *   variants, for WebContext::serveStatic_P():
+ *
+ *      ./asset_gen ../../src/CommonAssets.h ../assets/styles.css
+ *
+ *   styles.css becomes styles_css, styles_css_gz, styles_css_len, styles_css_gz_len, styles_css_hash and
+ *   styles_css_asset. CSS loses comments and the whitespace around punctuation, HTML loses comments and the
+ *   whitespace between tags, and other files are copied as they are. Output is deterministic, so the generated
+ *   header only changes when an asset does.
+ */
+
+#include <zlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <string>
+
+/**
+ *   Same as fnv1a() in CommonProgmem.cpp. The generator does not link the library, which includes its output.
+ */
+static uint32_t fnv1a(const char* data, size_t len) {
+  uint32_t h = 2166136261u;
+  for( size_t i=0; i<len; i++ ) {h ^= (uint8_t)data[i]; h *= 16777619u;}
+  return h;
+}
+
+static bool readFile(const char* path, std::string& out) {
+  FILE* f = fopen(path,"rb");
+  if( f == NULL ) return false;
+  char buffer[4096];
+  size_t n;
+  while( (n = fread(buffer,1,sizeof(buffer),f)) > 0 ) out.append(buffer,n);
+  fclose(f);
+  return true;
+}
+
+static bool endsWith(const std::string& s, const char* suffix) {
+  size_t n = strlen(suffix);
+  return (s.length() >= n) && (strcasecmp(s.c_str()+s.length()-n,suffix) == 0);
+}
+
+/**
+ *   Strip comments, collapse whitespace, and drop it next to { } ; , > and after ':'. Quoted strings are
+ *   copied unchanged. Whitespace before ':' is kept, since "a :hover" and "a:hover" select different elements.
+ */
+static std::string minifyCss(const std::string& in) {
+  std::string out;
+  bool space = false;
+  for( size_t i=0; i<in.length(); i++ ) {
+    char c = in[i];
+    if( (c == '/') && (i+1 < in.length()) && (in[i+1] == '*') ) {
+      size_t end = in.find("*/",i+2);
+      i = ((end == std::string::npos)?(in.length()):(end+1));
+      space = true;
+      continue;
+    }
+    if( isspace((unsigned char)c) ) {space = true; continue;}
+    if( (c == '"') || (c == '\'') ) {
+      if( space && !out.empty() && (strchr("{};,>:",out.back()) == NULL) ) out += ' ';
+      size_t end = i+1;
+      while( (end < in.length()) && (in[end] != c) ) end += ((in[end] == '\\')?(2):(1));
+      out.append(in,i,end-i+1);
+      i = end;
+      space = false;
+      continue;
+    }
+    if( strchr("{};,>",c) != NULL ) {
+      if( (c == '}') && !out.empty() && (out.back() == ';') ) out.erase(out.length()-1);
+      out += c;
+    }
+    else {
+      if( space && !out.empty() && (strchr("{};,>:",out.back()) == NULL) ) out += ' ';
+      out += c;
+    }
+    space = false;
+  }
+  return out;
+}
+
+/**
+ *   Strip <!-- comments -->, drop whitespace between tags and collapse other whitespace runs to a single space
+ */
+static std::string minifyHtml(const std::string& in) {
+  std::string out;
+  bool space = false;
+  for( size_t i=0; i<in.length(); i++ ) {
+    char c = in[i];
+    if( in.compare(i,4,"<!--") == 0 ) {
+      size_t end = in.find("-->",i+4);
+      i = ((end == std::string::npos)?(in.length()):(end+2));
+      continue;
+    }
+    if( isspace((unsigned char)c) ) {space = true; continue;}
+    if( space && !out.empty() && !((out.back() == '>') && (c == '<')) ) out += ' ';
+    out += c;
+    space = false;
+  }
+  return out;
+}
+
+static bool gzip(const std::string& in, std::string& out) {
+  z_stream z;
+  memset(&z,0,sizeof(z));
+  if( deflateInit2(&z,Z_BEST_COMPRESSION,Z_DEFLATED,15+16,9,Z_DEFAULT_STRATEGY) != Z_OK ) return false;
+  out.resize(deflateBound(&z,in.length()) + 32);
+  z.next_in   = (Bytef*)in.data();
+  z.avail_in  = in.length();
+  z.next_out  = (Bytef*)&out[0];
+  z.avail_out = out.length();
+  int result = deflate(&z,Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+  return result == Z_STREAM_END;
+}
+
+static const char* contentType(const std::string& path) {
+  if( endsWith(path,".css") )                              return "text/css";
+  if( endsWith(path,".html") || endsWith(path,".htm") )    return "text/html";
+  if( endsWith(path,".js") )                               return "application/javascript";
+  if( endsWith(path,".json") )                             return "application/json";
+  if( endsWith(path,".svg") )                              return "image/svg+xml";
+  return "application/octet-stream";
+}
+
+/**
+ *   C identifier from the file name: styles.css becomes styles_css
+ */
+static std::string symbol(const std::string& path) {
+  size_t slash = path.find_last_of('/');
+  std::string name = path.substr(((slash == std::string::npos)?(0):(slash+1)));
+  for( char& c : name ) {if( !isalnum((unsigned char)c) ) c = '_';}
+  if( name.empty() || isdigit((unsigned char)name[0]) ) name = "_" + name;
+  return name;
+}
+
+/**
+ *   Text as a string literal split over lines. Anything but printable ASCII, quotes and backslashes is written as
+ *   a 3 digit octal escape, which cannot run into the character that follows.
+ */
+static void writeString(FILE* f, const std::string& s) {
+  fprintf(f,"\n  \"");
+  int col = 0;
+  for( unsigned char c : s ) {
+    if( (c == '"') || (c == '\\') ) col += fprintf(f,"\\%c",c);
+    else if( (c >= 0x20) && (c < 0x7F) ) {fputc(c,f); col++;}
+    else col += fprintf(f,"\\%03o",c);
+    if( col >= 110 ) {fprintf(f,"\"\n  \""); col = 0;}
+  }
+  fprintf(f,"\"");
+}
+
+static void writeBytes(FILE* f, const std::string& s) {
+  fprintf(f," {");
+  for( size_t i=0; i<s.length(); i++ ) fprintf(f,"%s0x%02x%s",((i%20 == 0)?("\n  "):("")),(unsigned char)s[i],((i+1<s.length())?(","):("")));
+  fprintf(f,"\n}");
+}
+
+int main(int argc, char* argv[]) {
+  if( argc < 3 ) {fprintf(stderr,"usage: %s output.h asset...\n",argv[0]); return 1;}
+  std::string assets;
+  for( int i=2; i<argc; i++ ) {
+    std::string path(argv[i]);
+    std::string source;
+    if( !readFile(argv[i],source) ) {fprintf(stderr,"%s: cannot read %s\n",argv[0],argv[i]); return 1;}
+    std::string content = ((endsWith(path,".css"))?(minifyCss(source)):((endsWith(path,".html") || endsWith(path,".htm"))?(minifyHtml(source)):(source)));
+    std::string compressed;
+    if( !gzip(content,compressed) ) {fprintf(stderr,"%s: cannot compress %s\n",argv[0],argv[i]); return 1;}
+    std::string name = symbol(path);
+    size_t slash = path.find_last_of('/');
+    fprintf(stderr,"%s: %zu bytes, %zu minified, %zu gzip\n",path.substr(((slash == std::string::npos)?(0):(slash+1))).c_str(),source.length(),content.length(),compressed.length());
+
+    char*  text = NULL;
+    size_t len  = 0;
+    FILE*  f    = open_memstream(&text,&len);
+    fprintf(f,"/**\n *   %s, %s\n */\n",path.substr(((slash == std::string::npos)?(0):(slash+1))).c_str(),contentType(path));
+    fprintf(f,"constexpr size_t   %s_len      = %zu;\n",name.c_str(),content.length());
+    fprintf(f,"constexpr size_t   %s_gz_len   = %zu;\n",name.c_str(),compressed.length());
+    fprintf(f,"constexpr uint32_t %s_hash     = 0x%08lx;\n",name.c_str(),(unsigned long)fnv1a(content.data(),content.length()));
+    fprintf(f,"const char         %s_type[]   PROGMEM = \"%s\";\n",name.c_str(),contentType(path));
+    fprintf(f,"const char         %s[]        PROGMEM =",name.c_str());
+    writeString(f,content);
+    fprintf(f,";\nconst uint8_t      %s_gz[]     PROGMEM =",name.c_str());
+    writeBytes(f,compressed);
+    fprintf(f,";\nconst ProgmemAsset %s_asset   = {%s_type,%s,%s_len,(PGM_P)%s_gz,%s_gz_len,%s_hash};\n\n",
+            name.c_str(),name.c_str(),name.c_str(),name.c_str(),name.c_str(),name.c_str(),name.c_str());
+    fclose(f);
+    assets.append(text,len);
+    free(text);
+  }
+
+  FILE* out = fopen(argv[1],"w");
+  if( out == NULL ) {fprintf(stderr,"%s: cannot write %s\n",argv[0],argv[1]); return 1;}
+  fprintf(out,"/**\n *   Generated by extras/host/asset_gen from extras/assets, do not edit. Run make assets in extras/host after\n"
+              " *   changing an asset. Included by CommonProgmem.h inside namespace lsc.\n */\n\n");
+  fputs(assets.c_str(),out);
+  fclose(out);
+  return 0;
+}
@@ -0,0 +1,121 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/**
+ *   Shared harness for the host microbenchmarks. Each benchmark prints one JSON object per line to stdout:
+ *
+ *      {"bench":"formatBuffer_P/page","param":10,"iterations":...,"ns_per_op":...,"out_bytes_per_op":...,
+ *       "alloc_bytes_per_op":...,"allocs_per_op":...,"peak_stack":...}
+ *
+ *   where param is the benchmark size parameter, out_bytes_per_op is the value returned by the operation (normally
+ *   the number of bytes produced), alloc_bytes_per_op and allocs_per_op count heap use through malloc, and
+ *   peak_stack is the deepest stack use of a single operation, measured by running it once on a painted stack.
+ *
+ *   Benchmark programs take [filter] [min_ms] arguments, parsed by benchArgs(): only benchmarks whose name contains
+ *   filter are run, each for at least min_ms milliseconds (default 200).
+ */
+
+#ifndef HOST_BENCH_H
+#define HOST_BENCH_H
+
+#include <time.h>
+#include <ucontext.h>
+#include "CommonUtil.h"
+
+/**
+ *   Stack accounting: run a single operation on a private, painted stack and find the deepest byte touched
+ */
+#define BENCH_STACK_SIZE   65536
+#define BENCH_STACK_PAINT  0xA5
+
+static ucontext_t  mainContext;
+static ucontext_t  opContext;
+static char        opStack[BENCH_STACK_SIZE];
+static void      (*opTrampoline)(void*) = NULL;
+static void*       opArg                = NULL;
+
+static void runOnStack() {opTrampoline(opArg);}
+
+template<typename F>
+static void callOp(void* arg) {(*(F*)arg)();}
+
+template<typename F>
+size_t peakStack(F& op) {
+  memset(opStack,BENCH_STACK_PAINT,sizeof(opStack));
+  getcontext(&opContext);
+  opContext.uc_stack.ss_sp   = opStack;
+  opContext.uc_stack.ss_size = sizeof(opStack);
+  opContext.uc_link          = &mainContext;
+  opTrampoline               = &callOp<F>;
+  opArg                      = &op;
+  makecontext(&opContext,runOnStack,0);
+  swapcontext(&mainContext,&opContext);
+  size_t untouched = 0;
+  while( (untouched < sizeof(opStack)) && ((unsigned char)opStack[untouched] == BENCH_STACK_PAINT) ) untouched++;
+  return sizeof(opStack) - untouched;
+}
+
+static double nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return ts.tv_sec*1e9 + ts.tv_nsec;
+}
+
+static const char*     filter = NULL;
+static double          minNs  = 200e6;
+static volatile size_t sink   = 0;
+
+/**
+ *   Run op, which returns the number of bytes it produced, in batches until minNs has elapsed and report results.
+ */
+template<typename F>
+void bench(const char* name, int param, F op) {
+  if( (filter != NULL) && (strstr(name,filter) == NULL) ) return;
+  size_t out   = op();
+  for( int i=0; i<100; i++ ) sink += op();                    // Warm up, including lazy symbol binding
+  size_t stack = peakStack(op);
+
+  size_t bytes0 = hostAllocBytes();
+  size_t count0 = hostAllocCount();
+  long   iterations = 0;
+  long   batch = 64;
+  double start = nowNs();
+  double elapsed = 0;
+  while( elapsed < minNs ) {
+    for( long i=0; i<batch; i++ ) sink += op();
+    iterations += batch;
+    elapsed = nowNs() - start;
+    if( elapsed < minNs/10 ) batch *= 2;
+  }
+  printf("{\"bench\":\"%s\",\"param\":%d,\"iterations\":%ld,\"ns_per_op\":%.1f,\"out_bytes_per_op\":%zu,"
+         "\"alloc_bytes_per_op\":%.1f,\"allocs_per_op\":%.2f,\"peak_stack\":%zu}\n",
+         name,param,iterations,elapsed/iterations,out,
+         (double)(hostAllocBytes()-bytes0)/iterations,(double)(hostAllocCount()-count0)/iterations,stack);
+  fflush(stdout);
+}
+
+static void benchArgs(int argc, char* argv[]) {
+  if( argc > 1 ) filter = argv[1];
+  if( argc > 2 ) minNs  = atof(argv[2])*1e6;
+}
+
+#endif
@@ -0,0 +1,212 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/**
+ *   Comparison of WebContext, which reaches the server through std::function hooks, with DirectWebContext, which
+ *   calls the server inline, reported in the format described in Bench.h. Footprint lines report the size of each
+ *   context and the heap used by begin() and route registration. Binary size is compared by make context_size.
+ *   WebContext argument lookup by name is compared with a scan of argName(), String building with the request arena,
+ *   a page rendered per request with the same page served from the response cache, and HttpParser fed a request
+ *   whole and one byte at a time.
+ *
+ *      ./context_bench [filter] [min_ms]
+ */
+
+#include "Bench.h"
+
+using namespace lsc;
+
+static const char* request = "GET /device?name=RelayControl&state=on&channel=1&mode=auto&level=50&group=kitchen"
+                             "&urn=urn%3ALeelanauSoftware-com%3Adevice%3ARelayControl%3A1&ttl=1800 HTTP/1.1\r\n"
+                             "Host: localhost\r\n\r\n";
+
+/**
+ *  The arg loop of Simple::handleDevice, without formatting
+ */
+template<class Context>
+size_t readArgs(Context* c) {
+  size_t len = 0;
+  int    n   = c->argCount();
+  for( int i=0; i<n; i++ ) len += c->argName(i).length() + c->arg(i).length();
+  return len;
+}
+
+static const char* format(RequestArena& a, const char* format, ...) {
+  va_list args;
+  va_start(args,format);
+  const char* result = a.vformat(false,format,args);
+  va_end(args);
+  return result;
+}
+
+template<class Context>
+void footprint(const char* name, Context* c) {
+  size_t bytes0 = hostAllocBytes();
+  size_t count0 = hostAllocCount();
+  c->begin(0);
+  c->on("/",[](Context* c){c->send(200,"text/plain","root");});
+  c->on("/device",[](Context* c){char b[16]; snprintf(b,sizeof(b),"%u",(unsigned)readArgs(c)); c->send(200,"text/plain",b);});
+  c->on("/{device}/state",[](Context* c){c->send(200,"text/plain",c->pathArg("device"));});
+  printf("{\"bench\":\"%s/footprint\",\"sizeof\":%zu,\"setup_alloc_bytes\":%zu,\"setup_allocs\":%zu}\n",
+         name,sizeof(Context),hostAllocBytes()-bytes0,hostAllocCount()-count0);
+}
+
+template<class Context>
+void compare(const char* name, Context* c) {
+  char   label[64];
+  String response;
+  footprint(name,c);
+  c->inject(request,response);
+
+  snprintf(label,sizeof(label),"%s/args",name);
+  bench(label,c->argCount(),[c]()->size_t {return readArgs(c);});
+
+  snprintf(label,sizeof(label),"%s/uri",name);
+  bench(label,0,[c]()->size_t {return c->uri().length();});
+
+  snprintf(label,sizeof(label),"%s/inject",name);
+  bench(label,0,[c,&response]()->size_t {response.clear(); c->inject(request,response); return response.length();});
+}
+
+int main(int argc, char* argv[]) {
+  benchArgs(argc,argv);
+  compare("WebContext",new WebContext());
+  compare("DirectWebContext",new DirectWebContext());
+
+/**
+ *  Lookup of every argument by name, through the per-request ArgIndex and by scanning argName() as handlers did
+ *  before arg(name) was available
+ */
+  static const char* names[] = {"name","state","channel","mode","level","group","urn","ttl"};
+  WebContext* c = new WebContext();
+  String response;
+  c->begin(0);
+  c->on("/device",[](WebContext* c) {
+    bench("WebContext/argByName",8,[c]()->size_t {
+      size_t len = 0;
+      for( const char* n : names ) len += c->argView(n).length();
+      return len;
+    });
+    bench("WebContext/argByScan",8,[c]()->size_t {
+      size_t len = 0;
+      for( const char* n : names ) {
+        for( int i=0; i<c->argCount(); i++ ) {if( c->argName(i) == n ) {len += c->arg(i).length(); break;}}
+      }
+      return len;
+    });
+    c->send(200,"text/plain","");
+  });
+  c->inject(request,response);
+
+/**
+ *  Building eight links per request with String concatenation and in a RequestArena, reset per request as
+ *  WebContext does after each response
+ */
+  static const char* values[] = {"RelayControl","on","1","auto","50","kitchen","urn:LeelanauSoftware-com","1800"};
+  bench("links/String",8,[]()->size_t {
+    size_t len = 0;
+    for( int i=0; i<8; i++ ) {String link = String("/RelayControl/device?") + names[i] + "=" + values[i]; len += link.length();}
+    return len;
+  });
+  static RequestArena arena;
+  arena.claim();
+  bench("links/RequestArena",8,[]()->size_t {
+    size_t len = 0;
+    for( int i=0; i<8; i++ ) len += strlen(format(arena,"/RelayControl/device?%s=%s",names[i],values[i]));
+    arena.reset();
+    return len;
+  });
+
+/**
+ *  A nearby devices page, param buttons, rendered on every request, sent by HtmlPage with a Content-Length, and
+ *  served from the response cache
+ */
+  static const int rows[] = {10,50};
+  for( int n : rows ) {
+    WebContext* ctx = new WebContext();
+    ctx->begin(0);
+    auto page = [n](WebContext* c) {
+      ResponseWriter w(c);
+      w.begin(200,TEXT_HTML);
+      w.printf_P(html_header);
+      w.printf_P(html_title,"Nearby Devices");
+      for( int i=0; i<n; i++ ) w.printf_P(app_button,"/RelayControl/device",c->arg("name").c_str());
+      w.printf_P(html_tail);
+      w.end();
+    };
+    ctx->on("/device",page);
+    ctx->on("/cached",page);
+    ctx->on("/page",[n](WebContext* c) {
+      const char* name = c->arg("name").c_str();
+      HtmlPage page(c);
+      page.send(200,[n,name](HtmlPage& p) {
+        p.header().title("Nearby Devices");
+        for( int i=0; i<n; i++ ) p.appButton("/RelayControl/device",name);
+        p.tail();
+      });
+    });
+    ctx->cacheRoute("/cached",0,"devices");
+    ctx->setCacheBudget(65536);
+    bench("WebContext/render",n,[ctx,&response]()->size_t {response.clear(); ctx->inject(request,response); return response.length();});
+    bench("WebContext/HtmlPage",n,[ctx,&response]()->size_t {response.clear(); ctx->inject("GET /page?state=on&name=RelayControl HTTP/1.1\r\n\r\n",response); return response.length();});
+    bench("WebContext/cached",n,[ctx,&response]()->size_t {response.clear(); ctx->inject("GET /cached?state=on&name=RelayControl HTTP/1.1\r\n\r\n",response); return response.length();});
+  }
+
+/**
+ *  Parsing the device request, with its 8 arguments, arriving in one read and in one read per byte
+ */
+  static HttpParser parser;
+  size_t requestLen = strlen(request);
+  bench("HttpParser/whole",(int)requestLen,[requestLen]()->size_t {
+    parser.reset();
+    parser.feed(request,requestLen);
+    return parser.argCount();
+  });
+  bench("HttpParser/bytewise",(int)requestLen,[requestLen]()->size_t {
+    parser.reset();
+    for( size_t i=0; i<requestLen; i++ ) parser.feed(request+i,1);
+    return parser.argCount();
+  });
+
+/**
+ *  A status event broadcast to a full channel of subscribers, each a memory client with its own sink. A subscriber
+ *  injected with a response String that is gone by the next broadcast must be refused, not written to.
+ */
+  static String sinks[EVENT_MAX_CLIENTS];
+  WebContext*   events  = new WebContext();
+  events->begin(0);
+  EventChannel* channel = events->sse("/events");
+  {
+    String dropped;
+    events->inject("GET /events HTTP/1.1\r\n\r\n",dropped);
+  }
+  channel->send("{\"name\":\"RelayControl\",\"state\":\"off\"}","relay");
+  if( (channel->clients() != 0) || (channel->reaped() != 1) ) {fprintf(stderr,"context_bench: injected subscriber kept\n"); return 1;}
+  for( String& sink : sinks ) channel->subscribe(WiFiClient(&sink,IPAddress(127,0,0,1),0,IPAddress(127,0,0,1),0),NULL);
+  bench("EventChannel/send",channel->clients(),[channel]()->size_t {
+    size_t len = 0;
+    for( String& sink : sinks ) {len += sink.length(); sink.clear();}
+    channel->send("{\"name\":\"RelayControl\",\"state\":\"on\"}","relay");
+    return len;
+  });
+  return 0;
+}
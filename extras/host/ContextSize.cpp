@@ -0,0 +1,53 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/**
+ *   Minimal server program for comparing binary size, built once with WebContext and once, with STATIC_CONTEXT
+ *   defined, with DirectWebContext. See make context_size.
+ */
+
+#include "CommonUtil.h"
+
+using namespace lsc;
+
+#ifdef STATIC_CONTEXT
+typedef DirectWebContext Context;
+#else
+typedef WebContext       Context;
+#endif
+
+Context ctx;
+
+int main(int argc, char* argv[]) {
+  ctx.begin(0);
+  ctx.on("/",[](Context* c){c->send(200,"text/plain","root");});
+  ctx.on("/device",[](Context* c) {
+    char b[128];
+    int  pos = 0;
+    for( int i=0; i<c->argCount(); i++ ) pos = formatBuffer(b,sizeof(b),pos,"%s=%s ",c->argName(i).c_str(),c->arg(i).c_str());
+    c->send(200,"text/plain",b);
+  });
+  ctx.on("/{device}/state",[](Context* c){c->send(200,"text/plain",c->pathArg("device"));});
+  ctx.serveStatic_P("/styles.css",styles_css_asset);
+  String response;
+  return ((argc > 1)?(ctx.inject(argv[1],response)):(0));
+}
@@ -0,0 +1,183 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/**
+ *   Local load test of WebContext over real sockets. The server runs on the main thread, driven by handleClient()
+ *   as from loop(), while client threads play browsers: each opens a connection per request and records its
+ *   latency. Slow clients trickle their request a few bytes at a time, as a browser on a poor link does.
+ *   Results are one JSON line with latency percentiles in microseconds:
+ *
+ *      ./load_test [connections] [clients] [requests] [slow] [workers] [keepalive]
+ *
+ *   connections is the WebContext connection cap (0 serves one request per handleClient()), clients the number
+ *   of concurrent browsers, requests the requests each makes, slow the number of slow clients, and workers the
+ *   number of threads rendering pages (0 renders on the handleClient() thread). With keepalive set, browsers keep
+ *   their connection open across requests as WebContext::setKeepAlive() allows, and reuse counters are reported.
+ */
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "CommonUtil.h"
+
+using namespace lsc;
+
+static const char* request = "GET /device?name=RelayControl&state=on HTTP/1.1\r\nHost: localhost\r\n\r\n";
+
+static std::atomic<bool> running(true);
+
+static double nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return ts.tv_sec*1e6 + ts.tv_nsec/1e3;
+}
+
+static int connectTo(int port) {
+  int fd = socket(AF_INET,SOCK_STREAM,0);
+  struct sockaddr_in addr;
+  memset(&addr,0,sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = htons(port);
+  if( connect(fd,(struct sockaddr*)&addr,sizeof(addr)) != 0 ) {::close(fd); return -1;}
+  return fd;
+}
+
+/**
+ *   Send the request delay us apart in pieces of step bytes and read the response to EOF. Returns response bytes.
+ */
+static size_t get(int port, size_t step, unsigned delayUs) {
+  int fd = connectTo(port);
+  if( fd < 0 ) return 0;
+  size_t len = strlen(request);
+  for( size_t i=0; i<len; i+=step ) {
+    if( i > 0 ) usleep(delayUs);
+    ::send(fd,request+i,((len-i<step)?(len-i):(step)),MSG_NOSIGNAL);
+  }
+  char   buffer[4096];
+  size_t result = 0;
+  ssize_t n;
+  while( (n = recv(fd,buffer,sizeof(buffer),0)) > 0 ) result += n;
+  ::close(fd);
+  return result;
+}
+
+/**
+ *   Send the request on the open connection fd, or a new one if fd < 0, and read the chunked response through its
+ *   final chunk. fd is closed and set to -1 if the server closes the connection. A request that finds a reused
+ *   connection closed, idle too long or given up to another client, is retried on a new one as browsers do.
+ *   Returns response bytes.
+ */
+static size_t getKeepAlive(int port, int& fd) {
+  bool reused = (fd >= 0);
+  if( fd < 0 ) fd = connectTo(port);
+  if( fd < 0 ) return 0;
+  ::send(fd,request,strlen(request),MSG_NOSIGNAL);
+  char    buffer[16384];
+  size_t  len = 0;
+  ssize_t n;
+  while( (n = recv(fd,buffer+len,sizeof(buffer)-1-len,0)) > 0 ) {
+    len += n;
+    buffer[len] = '\0';
+    if( (len >= 7) && (memcmp(buffer+len-7,"\r\n0\r\n\r\n",7) == 0) ) break;
+    if( len == sizeof(buffer)-1 ) len = 0;
+  }
+  if( (n <= 0) || (strstr(buffer,"Connection: close") != NULL) ) {::close(fd); fd = -1;}
+  if( (len == 0) && reused ) return getKeepAlive(port,fd);
+  return len;
+}
+
+static double percentile(std::vector<double>& v, double p) {
+  if( v.empty() ) return 0;
+  size_t i = (size_t)(p*(v.size()-1));
+  std::nth_element(v.begin(),v.begin()+i,v.end());
+  return v[i];
+}
+
+int main(int argc, char* argv[]) {
+  int connections = ((argc > 1)?(atoi(argv[1])):(8));
+  int clients     = ((argc > 2)?(atoi(argv[2])):(8));
+  int requests    = ((argc > 3)?(atoi(argv[3])):(200));
+  int slow        = ((argc > 4)?(atoi(argv[4])):(1));
+  int workers     = ((argc > 5)?(atoi(argv[5])):(0));
+  int keepAlive   = ((argc > 6)?(atoi(argv[6])):(0));
+
+  WebContext ctx;
+  ctx.begin(0);
+  ctx.setMaxConnections(connections);
+  ctx.setWorkers(workers);
+  if( keepAlive ) ctx.setKeepAlive(5000);
+  ctx.on("/device",[](WebContext* c) {
+    ResponseWriter w(c);
+    w.begin(200,TEXT_HTML);
+    w.printf_P(html_header);
+    w.printf_P(html_title,"Load Test");
+    for( int i=0; i<50; i++ ) w.printf_P(app_button,"/RelayControl/device",c->arg("name").c_str());
+    w.printf_P(html_tail);
+    w.end();
+  });
+  int port = ctx.getLocalPort();
+
+  std::vector<std::vector<double>> latencies(clients);
+  std::vector<std::thread>         threads;
+  std::atomic<int>                 done(0);
+  for( int i=0; i<clients; i++ ) {
+    threads.emplace_back([i,port,requests,keepAlive,&latencies,&done]() {
+      int fd = -1;
+      for( int r=0; r<requests; r++ ) {
+        double start = nowUs();
+        if( ((keepAlive)?(getKeepAlive(port,fd)):(get(port,4096,0))) > 0 ) latencies[i].push_back(nowUs()-start);
+      }
+      if( fd >= 0 ) ::close(fd);
+      done++;
+    });
+  }
+  std::atomic<int> slowDone(0);
+  for( int i=0; i<slow; i++ ) {
+    threads.emplace_back([port,&slowDone]() {while( running ) get(port,8,20000); slowDone++;});
+  }
+
+  double start = nowUs();
+  while( done < clients ) {ctx.handleClient(); usleep(50);}
+  double elapsed = nowUs() - start;
+  running = false;
+  while( slowDone < slow ) {ctx.handleClient(); usleep(50);}
+  for( std::thread& t : threads ) t.join();
+
+  std::vector<double> all;
+  for( std::vector<double>& v : latencies ) all.insert(all.end(),v.begin(),v.end());
+  size_t count = all.size();
+  double p50 = percentile(all,0.50);
+  double p90 = percentile(all,0.90);
+  double p99 = percentile(all,0.99);
+  double max = ((all.empty())?(0):(*std::max_element(all.begin(),all.end())));
+  ConnectionStats stats = ctx.connectionStats();
+  printf("{\"bench\":\"load\",\"connections\":%d,\"workers\":%d,\"keepalive\":%d,\"clients\":%d,\"slow\":%d,\"requests\":%zu,\"req_per_s\":%.0f,"
+         "\"p50_us\":%.0f,\"p90_us\":%.0f,\"p99_us\":%.0f,\"max_us\":%.0f,\"accepted\":%lu,\"reused\":%lu}\n",
+         connections,workers,keepAlive,clients,slow,count,count/(elapsed/1e6),p50,p90,p99,max,stats.accepted,stats.reused);
+  return 0;
+}
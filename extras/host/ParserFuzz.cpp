@@ -0,0 +1,212 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/**
+ *   Differential fuzzer for HttpParser. Each input is parsed whole and again split into reads at points taken from
+ *   the input, and both parses must agree on state, error, method, path, headers, arguments and body, with every
+ *   string inside the parser. Input that completes is then followed by a pipelined request, which next() must find
+ *   with the '+' in its path kept and the one in its query decoded to a space.
+ *   A third parse streams the body, consuming it in pieces, and must see the same body as the parse that collected it.
+ *   With clang, build against libFuzzer and let it generate inputs:
+ *
+ *      clang++ -std=gnu++11 -g -fsanitize=fuzzer,address,undefined -DLIBFUZZER -I../../src ParserFuzz.cpp ../../src/*.cpp
+ *
+ *   Otherwise make fuzz builds a standalone driver that mutates seed requests, under AddressSanitizer and
+ *   UndefinedBehaviorSanitizer, and reports one JSON line:
+ *
+ *      ./parser_fuzz [iterations] [seed]
+ */
+
+#include "CommonUtil.h"
+
+using namespace lsc;
+
+static HttpParser whole;
+static HttpParser split;
+static HttpParser streamed;
+static char       body[2*HTTP_MAX_REQUEST];
+
+static void check(bool ok, const char* what) {
+  if( !ok ) {fprintf(stderr,"parser_fuzz: %s\n",what); abort();}
+}
+
+static void checkString(const HttpParser& p, const char* s) {
+  const char* buffer = (const char*)&p;
+  check((s != NULL) && ((*s == '\0') || ((s >= buffer) && (s + strlen(s) < buffer + sizeof(HttpParser)))),"string outside the parser");
+}
+
+static void same(const char* a, const char* b, const char* what) {
+  check(strcmp(a,b) == 0,what);
+}
+
+static void compare(const HttpParser& a, const HttpParser& b) {
+  check(a.state() == b.state(),"state differs");
+  check(a.error() == b.error(),"error differs");
+  if( !a.complete() ) return;
+  same(a.method(),b.method(),"method differs");
+  same(a.path(),b.path(),"path differs");
+  check(a.keepAlive() == b.keepAlive(),"keepAlive differs");
+  check(a.contentLength() == b.contentLength(),"contentLength differs");
+  check(memcmp(a.body(),b.body(),a.contentLength()) == 0,"body differs");
+  check(a.headerCount() == b.headerCount(),"headerCount differs");
+  for( int i=0; i<a.headerCount(); i++ ) {
+    same(a.headerName(i),b.headerName(i),"header name differs");
+    same(a.headerValue(i),b.headerValue(i),"header value differs");
+    check(a.headerIndex(a.headerName(i)) <= i,"headerIndex past the header");
+    checkString(a,a.headerName(i));
+    checkString(a,a.headerValue(i));
+  }
+  check(a.argCount() == b.argCount(),"argCount differs");
+  for( int i=0; i<a.argCount(); i++ ) {
+    same(a.argName(i),b.argName(i),"arg name differs");
+    check((a.argLength(i) == b.argLength(i)) && (memcmp(a.arg(i),b.arg(i),a.argLength(i)) == 0),"arg differs");
+    check(a.argIndex(a.argName(i)) <= i,"argIndex past the arg");
+  }
+  checkString(a,a.method());
+  checkString(a,a.path());
+}
+
+static void stream(const uint8_t* data, size_t size, const char* pipelined, size_t pipelinedLen) {
+  streamed.setStreamFunction([](const HttpParser&)->bool {return true;});
+  streamed.reset();
+  size_t pos  = 0;
+  size_t got  = 0;
+  size_t step = 1;
+  while( (streamed.state() != HTTP_COMPLETE) && (streamed.state() != HTTP_ERROR) ) {
+    size_t avail;
+    char*  to = streamed.space(avail);
+    size_t n  = ((step < size-pos)?(step):(size-pos));
+    if( n > avail ) n = avail;
+    memcpy(to,data+pos,n);
+    streamed.received(n);
+    pos += n;
+    size_t      len;
+    const char* b;
+    while( (streamed.state() == HTTP_STREAM) && ((b = streamed.bodyData(len)) != NULL) ) {
+      size_t take = 1 + data[(pos+got) % size] % 97;
+      if( take > len ) take = len;
+      check(got + take <= sizeof(body),"streamed body past the input");
+      memcpy(body+got,b,take);
+      got += take;
+      streamed.consume(take);
+    }
+    if( pos == size ) break;
+    step = 1 + (data[pos % size] % 251);
+  }
+  if( whole.complete() ) {
+    check(streamed.complete(),"streamed request incomplete");
+    same(whole.path(),streamed.path(),"streamed path differs");
+    check(streamed.streamed() == (whole.contentLength() > 0),"body not streamed");
+    const uint8_t* input = data + whole.length() - ((got > 0)?(got+1):(0));   // whole.body() is decoded in place
+    check((got == whole.contentLength()) && (memcmp(body,input,got) == 0),"streamed body differs");
+    size_t rest = streamed.buffered() - streamed.length();
+    streamed.feed(pipelined,pipelinedLen);
+    if( (streamed.next() == HTTP_COMPLETE) && (rest == 0) ) same(streamed.path(),"/next+1","pipelined request lost after stream");
+  }
+  else if( whole.failed() && (whole.error() != 413) ) check(streamed.failed() && (streamed.error() == whole.error()),"streamed error differs");
+}
+
+static void fuzz(const uint8_t* data, size_t size) {
+  static const char pipelined[] = "GET /next+1?a=1+2 HTTP/1.1\r\n\r\n";
+  whole.reset();
+  whole.feed((const char*)data,size);
+  split.reset();
+  size_t pos  = 0;
+  size_t step = 1;
+  while( (pos < size) && (split.state() != HTTP_COMPLETE) && (split.state() != HTTP_ERROR) ) {
+    size_t n = ((step < size-pos)?(step):(size-pos));
+    split.feed((const char*)data+pos,n);
+    pos += n;
+    step = 1 + (data[pos % size] % 17);
+  }
+  if( pos < size ) split.feed((const char*)data+pos,size-pos);
+  compare(whole,split);
+  if( size > 0 ) stream(data,size,pipelined,sizeof(pipelined)-1);
+  if( whole.complete() && (whole.buffered() + sizeof(pipelined) < HTTP_MAX_REQUEST) ) {
+    size_t rest = whole.buffered() - whole.length() - ((whole.contentLength() > 0)?(1):(0));
+    whole.feed(pipelined,sizeof(pipelined)-1);
+    if( whole.next() == HTTP_COMPLETE && (rest == 0) ) {
+      same(whole.path(),"/next+1","pipelined request lost, or '+' in its path decoded");
+      check((whole.argCount() == 1) && (strcmp(whole.arg(0),"1 2") == 0),"pipelined args lost");
+    }
+  }
+}
+
+#ifdef LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  fuzz(data,size);
+  return 0;
+}
+
+#else
+
+static const char* seeds[] = {
+  "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n",
+  "GET /a+b/c%2Bd?x=a+b HTTP/1.1\r\n\r\n",
+  "GET /device?name=RelayControl&state=on&urn=urn%3ALeelanauSoftware-com%3Adevice&ttl=1800 HTTP/1.1\r\nHost: x\r\n\r\n",
+  "POST /config HTTP/1.1\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: 21\r\n\r\nssid=home&pass=a%20b+c",
+  "POST /upload HTTP/1.0\r\nConnection: keep-alive\r\nContent-Length: 5\r\n\r\nhello",
+  "\r\nGET /a%zz?x&=y&&z= HTTP/1.1\nAccept-Encoding: gzip\n\n",
+  "GET /x HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 4\r\n\r\nabcd",
+  "GET /x HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n",
+};
+
+static uint32_t state = 1;
+static uint32_t rnd() {state ^= state << 13; state ^= state >> 17; state ^= state << 5; return state;}
+
+static size_t mutate(uint8_t* data, size_t size, size_t max) {
+  int edits = 1 + rnd() % 4;
+  for( int e=0; e<edits; e++ ) {
+    size_t at = ((size > 0)?(rnd() % size):(0));
+    switch( rnd() % 6 ) {
+      case 0: if( size > 0 ) data[at] = rnd(); break;
+      case 1: if( size > 0 ) data[at] = "\r\n :?&=%+\t"[rnd() % 11]; break;
+      case 2: if( size > 0 ) {size_t n = 1 + rnd() % 8; if( n > size-at ) n = size-at; memmove(data+at,data+at+n,size-at-n); size -= n;} break;
+      case 3: if( size < max ) {memmove(data+at+1,data+at,size-at); data[at] = rnd(); size++;} break;
+      case 4: if( (size > 0) && (size*2 <= max) && (rnd() % 8 == 0) ) {memcpy(data+size,data,size); size *= 2;} break;
+      case 5: if( size > 0 ) {size_t n = rnd() % (size-at+1); size_t to = rnd() % size; if( n > size-to ) n = size-to; memmove(data+to,data+at,n);} break;
+    }
+  }
+  return size;
+}
+
+int main(int argc, char* argv[]) {
+  long iterations = ((argc > 1)?(atol(argv[1])):(1000000));
+  state = ((argc > 2)?(strtoul(argv[2],NULL,10)):(1)) | 1;
+  static uint8_t data[2*HTTP_MAX_REQUEST];
+  long complete = 0;
+  long errors   = 0;
+  for( long i=0; i<iterations; i++ ) {
+    const char* seed = seeds[i % (sizeof(seeds)/sizeof(seeds[0]))];
+    size_t size = strlen(seed);
+    memcpy(data,seed,size);
+    size = mutate(data,size,sizeof(data));
+    fuzz(data,size);
+    if( whole.complete() )                  complete++;
+    else if( whole.state() == HTTP_ERROR )  errors++;
+  }
+  printf("{\"bench\":\"HttpParser/fuzz\",\"iterations\":%ld,\"complete\":%ld,\"rejected\":%ld}\n",iterations,complete,errors);
+  return 0;
+}
+
+#endif
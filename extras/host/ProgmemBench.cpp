@@ -0,0 +1,246 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/**
+ *   Microbenchmarks for the CommonProgmem formatting and tokenizing primitives and route matching, reported in the
+ *   format described in Bench.h, where param is the button rows, URN depth, input length or route count.
+ *   The scan benchmarks compare findDelim with the byte at a time loop URNTokenIterator uses, over URN tokens and
+ *   query strings and over a string of 200 byte tokens.
+ *
+ *      ./progmem_bench [filter] [min_ms]
+ */
+
+#include "Bench.h"
+
+using namespace lsc;
+
+/**
+ *   Realistic inputs
+ */
+static char pageBuffer[32768];
+
+static const char* b64Short = "dGhpcyBpcyBhIHNpZ25hdHVyZQ+/x4k2b+FaQ1s9Zw==";
+static char        b64Long[1025];
+
+static const char* urns[] = {
+  "urn:schemas-upnp-org",
+  "urn:LeelanauSoftware-com:device:RelayControl:1",
+  "urn:LeelanauSoftware-com:service:Configuration:1:sub:Relay:2:channel:7",
+  "urn:LeelanauSoftware-com:device:RelayControl:1:uuid:3f2504e0-4f89-11d3-9a0c-0305e82c3301:root:device:Sensor:2:x:y"
+};
+
+static char longUrn[1025];
+static char longQuery[1025];
+static char longTokens[1025];
+
+/**
+ *   Token count through the byte at a time loop URNTokenIterator uses, for comparison
+ */
+static size_t countBytewise(const char* str, char delim) {
+  size_t count = 0;
+  for( const char* p = str; *p != '\0'; ) {
+    while( (*p != '\0') && (*p != delim) ) p++;
+    count++;
+    if( *p == delim ) p++;
+  }
+  return count;
+}
+
+static size_t countFindDelim(const char* str, char delim) {
+  size_t count = 0;
+  for( const char* p = str; *p != '\0'; ) {
+    p = findDelim(p,delim);
+    count++;
+    if( *p == delim ) p++;
+  }
+  return count;
+}
+
+int main(int argc, char* argv[]) {
+  benchArgs(argc,argv);
+
+  for( size_t i=0; i<sizeof(b64Long)-1; i++ ) b64Long[i] = b64Short[i%strlen(b64Short)];
+  b64Long[sizeof(b64Long)-1] = '\0';
+
+  int rows[] = {1,10,50,100};
+  for( int n : rows ) {
+    bench("formatBuffer_P/page",n,[n]()->size_t {
+      int size = sizeof(pageBuffer);
+      int pos  = formatBuffer_P(pageBuffer,size,0,html_header);
+      pos = formatBuffer_P(pageBuffer,size,pos,html_title,"Nearby Devices");
+      for( int i=0; i<n; i++ ) pos = formatBuffer_P(pageBuffer,size,pos,app_button,"/RelayControl/device","Relay Control");
+      pos = formatBuffer_P(pageBuffer,size,pos,html_tail);
+      return pos;
+    });
+  }
+
+  for( int n : rows ) {
+    bench("BufferBuilder/page",n,[n]()->size_t {
+      BufferBuilder b(pageBuffer,sizeof(pageBuffer));
+      b.append_P(html_header);
+      b.append_P(html_title,"Nearby Devices");
+      for( int i=0; i<n; i++ ) b.append_P(app_button,"/RelayControl/device","Relay Control");
+      b.append_P(html_tail);
+      return b.position();
+    });
+  }
+
+  for( int n : rows ) {
+    bench("HtmlTemplate/page",n,[n]()->size_t {
+      BufferBuilder b(pageBuffer,sizeof(pageBuffer));
+      html_header_tmpl.render(b);
+      html_title_tmpl.render(b,"Nearby Devices");
+      for( int i=0; i<n; i++ ) app_button_tmpl.render(b,"/RelayControl/device","Relay Control");
+      html_tail_tmpl.render(b);
+      return b.position();
+    });
+  }
+
+  for( int n : rows ) {
+    bench("formatBuffer/rows",n,[n]()->size_t {
+      int size = sizeof(pageBuffer);
+      int pos  = 0;
+      for( int i=0; i<n; i++ ) pos = formatBuffer(pageBuffer,size,pos,"<tr><td>%s</td><td>%d</td></tr>","Relay",i);
+      return pos;
+    });
+  }
+
+  bench("formatHeader+formatTail",0,[]()->size_t {
+    int size = sizeof(pageBuffer);
+    int pos  = formatHeader(pageBuffer,size,"Device Configuration");
+    return formatTail(pageBuffer,size,pos);
+  });
+
+  bench("base64ToURL",strlen(b64Short),[]()->size_t {return base64ToURL(pageBuffer,sizeof(pageBuffer),0,b64Short);});
+  bench("base64ToURL",strlen(b64Long),[]()->size_t {return base64ToURL(pageBuffer,sizeof(pageBuffer),0,b64Long);});
+
+/**
+ *  URL and base64 codec, on base64 text (escapes in a run of plain text) and on a URL with a query string
+ */
+  static const char* url = "http://192.168.1.12:80/RelayControl/device?name=Relay Control&state=on&ssid=Leelanau Software";
+  static uint8_t     binary[768];
+  for( size_t i=0; i<sizeof(binary); i++ ) binary[i] = (uint8_t)(i*131);
+  bench("urlEncode",strlen(b64Long),[]()->size_t {return urlEncode(pageBuffer,sizeof(pageBuffer),0,b64Long);});
+  bench("urlEncode",strlen(url),[]()->size_t {return urlEncode(pageBuffer,sizeof(pageBuffer),0,url);});
+  bench("urlEncodedLength",strlen(b64Long),[]()->size_t {return urlEncodedLength(b64Long,strlen(b64Long));});
+  bench("urlEncode+urlDecode",strlen(url),[]()->size_t {urlEncode(pageBuffer,sizeof(pageBuffer),0,url); return urlDecode(pageBuffer);});
+  bench("base64Encode",sizeof(binary),[]()->size_t {return base64Encode(pageBuffer,sizeof(pageBuffer),0,binary,sizeof(binary));});
+  bench("base64Decode",sizeof(binary),[]()->size_t {return base64Decode((uint8_t*)pageBuffer+2048,sizeof(pageBuffer)-2048,pageBuffer,base64EncodedLength(sizeof(binary)));});
+
+  for( const char* urn : urns ) {
+    int depth = URNTokenIterator(urn).size();
+
+    bench("URNTokenIterator/first+next",depth,[urn]()->size_t {
+      URNTokenIterator it(urn);
+      char   buffer[64];
+      size_t len = 0;
+      URNToken t = it.first();
+      t.getToken(buffer,sizeof(buffer));
+      len += strlen(buffer);
+      while( it.hasNext() ) {t = it.next(); t.getToken(buffer,sizeof(buffer)); len += strlen(buffer);}
+      return len;
+    });
+
+    bench("URNTokenIterator/getToken",depth,[urn,depth]()->size_t {
+      URNTokenIterator it(urn);
+      char   buffer[64];
+      size_t len = 0;
+      for( int i=0; i<depth; i++ ) {it.getToken(i).getToken(buffer,sizeof(buffer)); len += strlen(buffer);}
+      return len;
+    });
+  }
+
+/**
+ *  Delimiter scanning over long URNs and query strings
+ */
+  for( size_t i=0; i<sizeof(longUrn)-1; i++ ) longUrn[i] = urns[3][i%strlen(urns[3])];
+  longUrn[sizeof(longUrn)-1] = '\0';
+  static const char* queryArg = "device=RelayControl&ssid=LeelanauSoftware&";
+  for( size_t i=0; i<sizeof(longQuery)-1; i++ ) longQuery[i] = queryArg[i%strlen(queryArg)];
+  longQuery[sizeof(longQuery)-1] = '\0';
+  for( size_t i=0; i<sizeof(longTokens)-1; i++ ) longTokens[i] = (((i % 200) == 199)?('&'):('a' + i%26));
+  longTokens[sizeof(longTokens)-1] = '\0';
+
+  const char* scanInputs[] = {urns[1], urns[3], longUrn};
+  for( const char* in : scanInputs ) {
+    bench("scan/bytewise/urn",strlen(in),[in]()->size_t {return countBytewise(in,':');});
+    bench("scan/findDelim/urn",strlen(in),[in]()->size_t {return countFindDelim(in,':');});
+  }
+  bench("scan/bytewise/query&",strlen(longQuery),[]()->size_t {return countBytewise(longQuery,'&');});
+  bench("scan/findDelim/query&",strlen(longQuery),[]()->size_t {return countFindDelim(longQuery,'&');});
+  bench("scan/bytewise/query=",strlen(longQuery),[]()->size_t {return countBytewise(longQuery,'=');});
+  bench("scan/findDelim/query=",strlen(longQuery),[]()->size_t {return countFindDelim(longQuery,'=');});
+  bench("scan/bytewise/long",strlen(longTokens),[]()->size_t {return countBytewise(longTokens,'&');});
+  bench("scan/findDelim/long",strlen(longTokens),[]()->size_t {return countFindDelim(longTokens,'&');});
+  bench("URNTokenIterator/size",strlen(longUrn),[]()->size_t {return URNTokenIterator(longUrn).size();});
+
+/**
+ *  SSDP search target match, copying tokens out and comparing in place
+ */
+  static const char* st = "urn:schemas-upnp-org:device:RelayControl:1";
+  bench("URNTokenIterator/st+strcmp",5,[]()->size_t {
+    URNTokenIterator it(st);
+    char type[32];
+    char name[32];
+    it.getToken(2).getToken(type,sizeof(type));
+    it.getToken(3).getToken(name,sizeof(name));
+    return (strcmp(type,"device") == 0) && (strcmp(name,"RelayControl") == 0);
+  });
+  bench("URNTokenIterator/st+equals",5,[]()->size_t {
+    URNTokenIterator it(st);
+    return (it.size() == 5) && (it[2] == "device") && (it[3] == "RelayControl");
+  });
+
+/**
+ *  Route dispatch for the last of n routes, through RouteTable and through a linear scan with strcmp as done by
+ *  the server handler lists
+ */
+  static const int routeCounts[] = {4, 32, 256};
+  for( int n : routeCounts ) {
+    static char patterns[256][48];
+    RouteTable* table = new RouteTable();
+    for( int i=0; i<n; i++ ) {
+      snprintf(patterns[i],sizeof(patterns[i]),"/device%d/nearbyDevices",i);
+      table->add(patterns[i]);
+    }
+    table->add("/{device}/info");
+    const char* path = patterns[n-1];
+
+    bench("RouteTable/match",n,[table,path]()->size_t {
+      RouteParams params;
+      return table->match(path,params);
+    });
+
+    bench("RouteTable/match+param",n,[table]()->size_t {
+      RouteParams params;
+      return table->match("/device7/info",params) + params.value(0).length();
+    });
+
+    bench("linear/match",n,[n,path]()->size_t {
+      int i = 0;
+      while( (i < n) && (strcmp(patterns[i],path) != 0) ) i++;
+      return i;
+    });
+    delete table;
+  }
+  return 0;
+}
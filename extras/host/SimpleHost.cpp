@@ -0,0 +1,81 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/**
+ *   Host build of the Simple example. The handlers in examples/Simple are compiled unchanged against the Linux
+ *   WebContext backend and either served on a real socket or driven in-process by replaying requests:
+ *
+ *      ./simple_host serve 8080            Serve on port 8080 until killed
+ *      ./simple_host serve 8080 8          Serve up to 8 connections at once, event driven
+ *      ./simple_host replay 100000         Replay 100000 requests round robin over the Simple routes
+ *
+ *   Replay mode has no socket overhead and is intended for perf and valgrind, for example:
+ *      perf record -g ./simple_host replay 100000 > /dev/null
+ */
+
+#include <time.h>
+#include "Simple.h"
+
+using namespace lsc;
+
+WebContext  ctx;
+
+static const char* requests[] = {
+  "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n",
+  "GET /device?name=RelayControl&state=on&urn=urn%3ALeelanauSoftware-com%3Adevice%3ARelayControl%3A1 HTTP/1.1\r\nHost: localhost\r\n\r\n",
+  "GET /request HTTP/1.1\r\nHost: localhost\r\n\r\n",
+  "GET /styles.css HTTP/1.1\r\nHost: localhost\r\n\r\n"
+};
+
+int main(int argc, char* argv[]) {
+  const char* mode  = ((argc > 1)?(argv[1]):("replay"));
+  long        count = ((argc > 2)?(atol(argv[2])):(1000));
+
+  ctx.begin(((strcmp(mode,"serve") == 0)?((int)count):(0)));
+  if( argc > 3 ) ctx.setMaxConnections(atoi(argv[3]));
+  ctx.on("/",[](WebContext* c){Simple::handleRoot(c);});
+  ctx.on("/device",[](WebContext* c){Simple::handleDevice(c);});
+  ctx.on("/request",[](WebContext* c){Simple::handleRequest(c);});
+  ctx.serveStatic_P("/styles.css",styles_css_asset);
+  ctx.enableLog();
+
+  if( strcmp(mode,"serve") == 0 ) {
+    fprintf(stderr,"Web Server started on port %d\n",ctx.getLocalPort());
+    for(;;) {ctx.handleClient(); Log.drain(); delay(1);}
+  }
+
+  size_t nRequests = sizeof(requests)/sizeof(requests[0]);
+  size_t bytes     = 0;
+  String response;
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC,&start);
+  for( long i=0; i<count; i++ ) {
+    response.clear();
+    if( ctx.inject(requests[i%nRequests],response) != 200 ) {fprintf(stderr,"Request %ld failed\n",i); return 1;}
+    bytes += response.length();
+    Log.drain();
+  }
+  clock_gettime(CLOCK_MONOTONIC,&end);
+  double ns = (end.tv_sec-start.tv_sec)*1e9 + (end.tv_nsec-start.tv_nsec);
+  fprintf(stderr,"%ld requests, %zu response bytes, %.0f ns/request\n",count,bytes,ns/((count>0)?(count):(1)));
+  return 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Read-only access to request arguments without copies. ArgView is a pointer and length over an argument name or
+ *  value held by the server, valid until the request completes. ArgIndex is a small open addressed hash table over
+ *  argument names, built once per request on the first lookup by name, so that each further lookup costs one hash
+ *  and one compare rather than a scan of every argument.
+ */
+
+#ifndef ARG_INDEX_H
+#define ARG_INDEX_H
+
+#include "CommonProgmem.h"
+
+#ifndef ARG_INDEX_ARGS
+#define ARG_INDEX_ARGS      16                   // Arguments indexed, any beyond are found by linear scan
+#endif
+#define ARG_INDEX_SLOTS     (2*ARG_INDEX_ARGS)
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+class ArgView {
+  public:
+  ArgView() {}
+  ArgView(const String& s)                                       {_ptr = s.c_str(); _len = s.length();}
+  ArgView(const char* s, size_t len)                             {_ptr = s; _len = len;}
+
+  const char* c_str() const                                      {return _ptr;}
+  size_t      length() const                                     {return _len;}
+  bool        isEmpty() const                                    {return _len == 0;}
+  bool        equals(const char* s) const                        {return (s != NULL) && (strncmp(_ptr,s,_len) == 0) && (s[_len] == '\0');}
+  long        toInt() const                                      {return strtol(_ptr,NULL,10);}
+
+  private:
+  const char* _ptr = "";
+  size_t      _len = 0;
+};
+
+class ArgIndex {
+  public:
+  ArgIndex() {}
+
+  void        clear()                                            {_count = -1;}
+  bool        built() const                                      {return _count >= 0;}
+
+/**
+ *   Index count arguments, where name(i) returns the name of argument i as a String or an ArgView over a '\0'
+ *   terminated name. When a name appears more than once the first is indexed.
+ */
+  template<typename F>
+  void        build(int count, F name) {
+    memset(_slots,0,sizeof(_slots));
+    _count = 0;
+    for( int i=0; (i<count) && (i<ARG_INDEX_ARGS); i++ ) {
+      ArgView       n(name(i));
+      uint32_t      h = fnv1a(n.c_str(),n.length());
+      unsigned      s = h & (ARG_INDEX_SLOTS-1);
+      bool          dup = false;
+      while( (_slots[s] != 0) && !dup ) {
+        dup = (_hashes[_slots[s]-1] == h) && ArgView(name(_slots[s]-1)).equals(n.c_str());
+        s   = (s+1) & (ARG_INDEX_SLOTS-1);
+      }
+      _hashes[i] = h;
+      if( !dup ) _slots[s] = i+1;
+    }
+    _count = count;
+  }
+
+/**
+ *   Index of the argument named key, or -1 if there is none
+ */
+  template<typename F>
+  int         find(const char* key, F name) const {
+    int result = -1;
+    if( (key != NULL) && built() ) {
+      uint32_t h = fnv1a(key,strlen(key));
+      for( unsigned s = h & (ARG_INDEX_SLOTS-1); (_slots[s] != 0) && (result < 0); s = (s+1) & (ARG_INDEX_SLOTS-1) ) {
+        int i = _slots[s]-1;
+        if( (_hashes[i] == h) && ArgView(name(i)).equals(key) ) result = i;
+      }
+      for( int i=ARG_INDEX_ARGS; (i<_count) && (result < 0); i++ ) {if( ArgView(name(i)).equals(key) ) result = i;}
+    }
+    return result;
+  }
+
+  private:
+  int         _count = -1;
+  uint8_t     _slots[ARG_INDEX_SLOTS];
+  uint32_t    _hashes[ARG_INDEX_ARGS];
+};
+
+} // End of namespace lsc
+
+#endif
@@ -0,0 +1,298 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "BodyDecoder.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+static int hexDigit(char c) {
+  return ((c >= '0') && (c <= '9'))?(c - '0'):(((c >= 'a') && (c <= 'f'))?(c - 'a' + 10):(((c >= 'A') && (c <= 'F'))?(c - 'A' + 10):(-1)));
+}
+
+/**
+ *   First case insensitive occurrence of find in s, or NULL
+ */
+static const char* caseFind(const char* s, const char* find) {
+  size_t n = strlen(find);
+  for( ; *s != '\0'; s++ ) {if( strncasecmp(s,find,n) == 0 ) return s;}
+  return NULL;
+}
+
+void FormDecoder::begin() {
+  _state     = FORM_NAME;
+  _nameLen   = 0;
+  _valueLen  = 0;
+  _escapeLen = 0;
+  _name[0]   = '\0';
+  _current.name = _name;
+}
+
+/**
+ *   Decode with the same rules as urlDecode(): '+' is a space, and a '%' not followed by two hex digits is kept
+ *   as it is along with the characters after it
+ */
+size_t FormDecoder::write(const char* data, size_t len) {
+  for( size_t i=0; i<len; i++ ) {
+    char c = data[i];
+    if( _escapeLen > 0 ) {
+      if( hexDigit(c) >= 0 ) {
+        if( _escapeLen == 2 ) {decoded((char)((hexDigit(_escape[1]) << 4) | hexDigit(c))); _escapeLen = 0;}
+        else                  _escape[_escapeLen++] = c;
+        continue;
+      }
+      for( int e=0; e<_escapeLen; e++ ) decoded(_escape[e]);
+      _escapeLen = 0;
+    }
+    if( c == '%' )                                    _escape[_escapeLen++] = c;
+    else if( c == '&' )                               end();
+    else if( (c == '=') && (_state == FORM_NAME) )    _state = FORM_VALUE;
+    else                                              decoded((c == '+')?(' '):(c));
+  }
+  return len;
+}
+
+/**
+ *   End the current field, if there is one. Called at each '&' and once after the last chunk, with aborted set if
+ *   the body was cut short.
+ */
+void FormDecoder::end(bool aborted) {
+  for( int e=0; e<_escapeLen; e++ ) decoded(_escape[e]);
+  _escapeLen = 0;
+  _current.aborted = aborted;
+  if( (_nameLen > 0) || (_state == FORM_VALUE) ) flush(true);
+  _current.aborted = false;
+  _state    = FORM_NAME;
+  _nameLen  = 0;
+  _name[0]  = '\0';
+}
+
+void FormDecoder::decoded(char c) {
+  if( _state == FORM_NAME ) {
+    if( _nameLen < BODY_NAME_MAX-1 ) {_name[_nameLen++] = c; _name[_nameLen] = '\0';}
+  }
+  else {
+    if( _valueLen == sizeof(_value) ) flush(false);
+    _value[_valueLen++] = c;
+  }
+}
+
+void FormDecoder::flush(bool last) {
+  if( (_valueLen > 0) || last ) _field(_current,_value,_valueLen,last);
+  _valueLen = 0;
+}
+
+/**
+ *   The boundary parameter of contentType, quoted or not. The delimiter is the boundary preceded by CRLF and "--";
+ *   the first may open the body, so matching starts as if a CRLF had just been read.
+ */
+bool MultipartDecoder::begin(const char* contentType) {
+  _state = PART_NONE;
+  if( (contentType == NULL) || (strncasecmp(contentType,"multipart/",10) != 0) ) return false;
+  const char* b = caseFind(contentType,"boundary=");
+  if( b == NULL ) return false;
+  b += 9;
+  bool   quoted = (*b == '"');
+  if( quoted ) b++;
+  size_t len = ((quoted)?(strcspn(b,"\"")):(strcspn(b,"; \t")));
+  if( (len == 0) || (len > BODY_BOUNDARY_MAX) ) return false;
+  memcpy(_delimiter,"\r\n--",4);
+  memcpy(_delimiter+4,b,len);
+  _delimiterLen = len + 4;
+  _match        = 2;
+  _state        = PART_PREAMBLE;
+  _current.name = _current.filename = _current.contentType = "";
+  return true;
+}
+
+size_t MultipartDecoder::write(const char* data, size_t len) {
+  size_t i = 0;
+  while( i < len ) {
+    char c = data[i];
+    switch( _state ) {
+      case PART_PREAMBLE: i = preamble(data,len,i); break;
+      case PART_DATA:     i = partData(data,len,i); break;
+      case PART_BOUNDARY:
+        if( c == '-' ) {if( ++_dashes == 2 ) _state = PART_EPILOGUE;}
+        else if( c == '\n' ) {
+          _state   = PART_HEADERS;
+          _lineLen = 0;
+          _name[0] = _filename[0] = _type[0] = '\0';
+        }
+        i++;
+        break;
+      case PART_HEADERS:
+        if( c == '\n' ) {
+          if( (_lineLen > 0) && (_line[_lineLen-1] == '\r') ) _lineLen--;
+          if( _lineLen == 0 ) {
+            _current.name        = _name;
+            _current.filename    = _filename;
+            _current.contentType = _type;
+            _state = PART_DATA;
+            _match = 0;
+          }
+          else headerLine();
+          _lineLen = 0;
+        }
+        else if( _lineLen < BODY_LINE_MAX-1 ) _line[_lineLen++] = c;
+        i++;
+        break;
+      default: i = len; break;
+    }
+  }
+  return len;
+}
+
+/**
+ *   Discard everything before the first delimiter. The only CR in a delimiter is its first byte, so after a
+ *   mismatch matching restarts at the current byte or not at all.
+ */
+size_t MultipartDecoder::preamble(const char* data, size_t len, size_t i) {
+  for( ; i<len; i++ ) {
+    char c = data[i];
+    if( c != _delimiter[_match] ) _match = 0;
+    if( c == _delimiter[_match] ) {
+      if( ++_match == _delimiterLen ) {_state = PART_BOUNDARY; _dashes = 0; _match = 0; return i+1;}
+    }
+  }
+  return len;
+}
+
+/**
+ *   Pass part data on, holding back bytes that may begin the delimiter until they are known to be data. Held back
+ *   bytes match the delimiter, so they are passed on from it rather than kept.
+ */
+size_t MultipartDecoder::partData(const char* data, size_t len, size_t i) {
+  size_t run = i;
+  for( ; i<len; i++ ) {
+    char c = data[i];
+    if( (_match > 0) && (c != _delimiter[_match]) ) {
+      emit(_delimiter,_match);
+      _match = 0;
+      run    = i;
+    }
+    if( c == _delimiter[_match] ) {
+      if( _match == 0 ) emit(data+run,i-run);
+      run = i+1;
+      if( ++_match == _delimiterLen ) {
+        _field(_current,"",0,true);
+        _state  = PART_BOUNDARY;
+        _dashes = 0;
+        _match  = 0;
+        return i+1;
+      }
+    }
+  }
+  if( _match == 0 ) emit(data+run,len-run);
+  return len;
+}
+
+bool MultipartDecoder::end() {
+  if( _state == PART_DATA ) {
+    emit(_delimiter,_match);
+    _current.aborted = true;
+    _field(_current,"",0,true);
+    _current.aborted = false;
+  }
+  bool done = complete();
+  _state = PART_NONE;
+  _match = 0;
+  return done;
+}
+
+/**
+ *   Copy the quoted or token value of param in header into to
+ */
+static void headerParam(const char* header, const char* param, char to[], size_t size) {
+  size_t      n = strlen(param);
+  const char* p = header;
+  while( (p = caseFind(p,param)) != NULL ) {
+    bool start = (p == header) || (p[-1] == ';') || (p[-1] == ' ') || (p[-1] == '\t');
+    p += n;
+    if( start && (*p == '=') ) {
+      p++;
+      bool   quoted = (*p == '"');
+      if( quoted ) p++;
+      size_t len = ((quoted)?(strcspn(p,"\"")):(strcspn(p,"; \t")));
+      if( len >= size ) len = size-1;
+      memcpy(to,p,len);
+      to[len] = '\0';
+      return;
+    }
+  }
+}
+
+void MultipartDecoder::headerLine() {
+  _line[_lineLen] = '\0';
+  char* value = strchr(_line,':');
+  if( value == NULL ) return;
+  *value++ = '\0';
+  value += strspn(value," \t");
+  if( strcasecmp(_line,"Content-Disposition") == 0 ) {
+    headerParam(value,"name",_name,sizeof(_name));
+    headerParam(value,"filename",_filename,sizeof(_filename));
+  }
+  else if( strcasecmp(_line,"Content-Type") == 0 ) {
+    size_t len = strlen(value);
+    if( len >= sizeof(_type) ) len = sizeof(_type)-1;
+    memcpy(_type,value,len);
+    _type[len] = '\0';
+  }
+}
+
+void BodyDecoder::begin(const char* contentType) {
+  if( contentType == NULL ) contentType = "";
+  if( _multipart.begin(contentType) ) _kind = BODY_MULTIPART;
+  else if( strncasecmp(contentType,"application/x-www-form-urlencoded",33) == 0 ) {
+    _kind = BODY_FORM;
+    _form.begin();
+  }
+  else {
+    _kind = BODY_PLAIN;
+    strlcpy(_type,contentType,sizeof(_type));
+    _plain.name        = "plain";
+    _plain.contentType = _type;
+  }
+}
+
+size_t BodyDecoder::write(const char* data, size_t len) {
+  switch( _kind ) {
+    case BODY_MULTIPART: return _multipart.write(data,len);
+    case BODY_FORM:      return _form.write(data,len);
+    default:             if( len > 0 ) _field(_plain,data,len,false); return len;
+  }
+}
+
+bool BodyDecoder::end(bool aborted) {
+  if( _kind == BODY_MULTIPART ) return _multipart.end() && !aborted;
+  if( _kind == BODY_FORM )      _form.end(aborted);
+  else {
+    _plain.aborted = aborted;
+    _field(_plain,"",0,true);
+    _plain.aborted = false;
+  }
+  return !aborted;
+}
+
+} // End of namespace lsc
@@ -0,0 +1,185 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Streaming decoders for form bodies, fed a request body in pieces as it arrives (see WebContext::onBody()) and
+ *  calling a FieldFunction with the data of each field in pieces of their own:
+ *
+ *    MultipartDecoder upload([](const BodyField& f, const char* data, size_t len, bool last) {
+ *      if( f.filename[0] != '\0' ) file.write(data,len);
+ *      if( last ) file.close();
+ *      if( f.aborted ) remove(f.filename);
+ *    });
+ *    upload.begin(contentType);
+ *    upload.write(chunk,len);                   // For each chunk, in order
+ *    upload.end();                              // After the last
+ *
+ *  FormDecoder splits application/x-www-form-urlencoded bodies at '&' and '=' and URL decodes each piece, with
+ *  escapes split across chunks decoded as if they were not. MultipartDecoder splits multipart/form-data bodies at
+ *  the boundary given by the Content-Type, with the name, filename and content type of each part from its headers.
+ *  Neither holds more than a field name and a header line, so a field of any size costs the same memory. Names and
+ *  header lines past their limit are truncated. BodyDecoder picks between them by Content-Type.
+ */
+
+#ifndef BODY_DECODER_H
+#define BODY_DECODER_H
+
+#include "CommonProgmem.h"
+#include <functional>
+
+#ifndef BODY_NAME_MAX
+#define BODY_NAME_MAX        64                  // Field name, filename and content type, including '\0'
+#endif
+#ifndef BODY_LINE_MAX
+#define BODY_LINE_MAX        256                 // Multipart header line, including '\0'
+#endif
+#define BODY_VALUE_CHUNK     64                  // Decoded urlencoded value bytes passed to the FieldFunction at once
+#define BODY_BOUNDARY_MAX    70                  // Longest boundary, RFC 2046
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+/**
+ *   The field being decoded. filename and contentType are "" for urlencoded fields and parts without them.
+ */
+struct BodyField {
+  const char*        name        = "";
+  const char*        filename    = "";
+  const char*        contentType = "";
+  bool               aborted     = false;        // Set on the last call of a field cut short by the end of the body
+};
+
+/**
+ *   Data of field f, len bytes at a time, with last set on its final call, which may have len 0
+ */
+typedef std::function<void(const BodyField& f, const char* data, size_t len, bool last)> FieldFunction;
+
+class FormDecoder {
+  public:
+  FormDecoder(FieldFunction f)                                   {_field = f; begin();}
+
+  void           begin();
+  size_t         write(const char* data, size_t len);
+  void           end(bool aborted=false);
+
+  private:
+  enum State {FORM_NAME, FORM_VALUE};
+
+  void           decoded(char c);
+  void           flush(bool last);
+
+  FieldFunction  _field;
+  BodyField      _current;
+  State          _state          = FORM_NAME;
+  char           _name[BODY_NAME_MAX];
+  size_t         _nameLen        = 0;
+  char           _value[BODY_VALUE_CHUNK];
+  size_t         _valueLen       = 0;
+  char           _escape[2];                                     // '%' and a hex digit of an escape not yet complete
+  int            _escapeLen      = 0;
+
+  FormDecoder(const FormDecoder&) = delete;
+  FormDecoder& operator=(const FormDecoder&) = delete;
+};
+
+class MultipartDecoder {
+  public:
+  MultipartDecoder(FieldFunction f)                              {_field = f;}
+
+/**
+ *   Start a body with the boundary from contentType, the request's Content-Type header. Returns false if it is not
+ *   multipart with a usable boundary, and the body is then ignored.
+ */
+  bool           begin(const char* contentType);
+  size_t         write(const char* data, size_t len);
+
+/**
+ *   End the body, passing on a part still open as aborted along with any bytes held back from it. Returns
+ *   complete(), false if the body ended before its closing boundary.
+ */
+  bool           end();
+
+/**
+ *   True once the closing boundary has been read
+ */
+  bool           complete() const                                {return _state == PART_EPILOGUE;}
+
+  private:
+  enum State {PART_NONE, PART_PREAMBLE, PART_BOUNDARY, PART_HEADERS, PART_DATA, PART_EPILOGUE};
+
+  size_t         preamble(const char* data, size_t len, size_t i);
+  size_t         partData(const char* data, size_t len, size_t i);
+  void           headerLine();
+  void           emit(const char* data, size_t len)             {if( len > 0 ) _field(_current,data,len,false);}
+
+  FieldFunction  _field;
+  BodyField      _current;
+  State          _state          = PART_NONE;
+  char           _delimiter[BODY_BOUNDARY_MAX+5];                // "\r\n--" boundary
+  size_t         _delimiterLen   = 0;
+  size_t         _match          = 0;                            // Delimiter bytes matched, held back from the data
+  int            _dashes         = 0;
+  char           _line[BODY_LINE_MAX];
+  size_t         _lineLen        = 0;
+  char           _name[BODY_NAME_MAX];
+  char           _filename[BODY_NAME_MAX];
+  char           _type[BODY_NAME_MAX];
+
+  MultipartDecoder(const MultipartDecoder&) = delete;
+  MultipartDecoder& operator=(const MultipartDecoder&) = delete;
+};
+
+/**
+ *   Decoder for a body of any Content-Type. Form bodies are split into their fields as above, and any other body is
+ *   passed on whole as the single field "plain", with the body's content type.
+ */
+class BodyDecoder {
+  public:
+  BodyDecoder(FieldFunction f) : _form(f), _multipart(f)        {_field = f;}
+
+  void           begin(const char* contentType);
+  size_t         write(const char* data, size_t len);
+
+/**
+ *   End the body, with aborted true if it was cut short, such as by its connection closing. A field left open is
+ *   passed on as aborted. Returns true if the body was complete.
+ */
+  bool           end(bool aborted=false);
+
+  private:
+  enum Kind {BODY_PLAIN, BODY_FORM, BODY_MULTIPART};
+
+  FieldFunction    _field;
+  FormDecoder      _form;
+  MultipartDecoder _multipart;
+  Kind             _kind         = BODY_PLAIN;
+  BodyField        _plain;
+  char             _type[BODY_NAME_MAX];
+
+  BodyDecoder(const BodyDecoder&) = delete;
+  BodyDecoder& operator=(const BodyDecoder&) = delete;
+};
+
+} // End of namespace lsc
+
+#endif
@@ -0,0 +1,77 @@
+/**
+ *   Generated by extras/host/asset_gen from extras/assets, do not edit. Run make assets in extras/host after
+ *   changing an asset. Included by CommonProgmem.h inside namespace lsc.
+ */
+
+/**
+ *   styles.css, text/css
+ */
+constexpr size_t   styles_css_len      = 2419;
+constexpr size_t   styles_css_gz_len   = 739;
+constexpr uint32_t styles_css_hash     = 0x71ed4f89;
+const char         styles_css_type[]   PROGMEM = "text/css";
+const char         styles_css[]        PROGMEM =
+  ".apButton{background:linear-gradient(to bottom,#ededed 5%,#bab1ba 100%);background-color:#ededed;border-radius"
+  ":12px;border:1px solid #d6bcd6;display:block;cursor:pointer;color:#3a8a9e;font-family:Arial;font-size:1.2em;pa"
+  "dding:.5em;width:100%;text-decoration:none;margin:0px auto 3px auto;text-shadow:0px 1px 0px #e1e2ed;text-align"
+  ":center}.apButton:hover{background:linear-gradient(to bottom,#bab1ba 5%,#ededed 100%);background-color:#bab1ba"
+  "}.apButton:active{position:relative;top:1px}[class*=\"small\"]{width:20%;display:inline-block}[class*=\"config"
+  "\"]{background:linear-gradient(to bottom,#ededed 5%,#9bb5cf 100%);background-color:#ededed;width:80%}.config:h"
+  "over{background:linear-gradient(to bottom,#9bb5cf 5%,#ededed 100%);background-color:#9bb5cf}@media only screen"
+  " and (min-width:768px){.small{width:10%}}[class*=\"medium\"]{width:50%;display:inline-block}@media only screen"
+  " and (min-width:768px){.medium{width:25%}}[class*=\"scaled\"]{width:80%}@media only screen and (min-width:768p"
+  "x){.scaled{width:40%}.config{width:40%}}label{font-family:Arial;font-size:1.2em;display:inline}.fmButton{backg"
+  "round:linear-gradient(to bottom,#ededed 5%,#bab1ba 100%);background-color:#ededed;border-radius:5px;border:1px"
+  " solid #d6bcd6;display:inline;cursor:pointer;color:#3a8a9e;font-family:Arial;font-size:1em;padding:.3em;width:"
+  "6em;text-decoration:none;margin:auto;text-shadow:0px 1px 0px #e1e2ed;text-align:center}.fmButton:hover{backgro"
+  "und:linear-gradient(to bottom,#bab1ba 5%,#ededed 100%);background-color:#bab1ba}.fmButton:active{position:rela"
+  "tive;top:1px}.toggle{cursor:pointer;display:inline-block}.toggle-switch{display:inline-block;background:#e5eef"
+  "c;border-radius:16px;border:1px solid #7faaf1;width:36px;height:20px;position:relative;vertical-align:middle;t"
+  "ransition:background 0.25s}.toggle-switch:before,.toggle-switch:after{content:\"\"}.toggle-switch:before{displ"
+  "ay:block;background:linear-gradient(to bottom,#fff 0%,#eee 100%);border-radius:50%;box-shadow:0 0 0 1px rgba(0"
+  ",0,0,0.25);width:15px;height:15px;position:absolute;top:3px;left:3px;transition:left 0.25s}.toggle:hover .togg"
+  "le-switch:before{background:linear-gradient(to bottom,#fff 0%,#fff 100%);box-shadow:0 0 0 1px rgba(0,0,0,0.5)}"
+  ".toggle-checkbox:checked + .toggle-switch{background:#7faaf1}.toggle-checkbox:checked + .toggle-switch:before{"
+  "left:18px}.toggle-checkbox{position:absolute;visibility:hidden}.toggle-label{margin-left:5px;position:relative"
+  ";top:2px}";
+const uint8_t      styles_css_gz[]     PROGMEM = {
+  0x1f,0x8b,0x08,0x00,0x00,0x00,0x00,0x00,0x02,0x03,0xbd,0x96,0xdb,0x8e,0xda,0x30,0x10,0x86,0x5f,0x25,
+  0x02,0x21,0x2d,0x2d,0x89,0x08,0x34,0x2c,0xeb,0xa8,0x52,0xdb,0xd7,0xa8,0x7a,0xe1,0xc3,0x24,0xb1,0xd6,
+  0xb1,0x23,0xc7,0xec,0x42,0xa3,0xbc,0x7b,0xed,0x9c,0x08,0x2c,0x5b,0xa0,0x55,0x2b,0x5f,0xc4,0x38,0x33,
+  0xf6,0x3f,0xdf,0x4c,0xc6,0x04,0xb8,0xf8,0xb6,0x33,0x46,0xc9,0x8a,0x60,0xfa,0x9c,0x6a,0xb5,0x93,0x0c,
+  0x09,0x2e,0x01,0x6b,0x3f,0xd5,0x98,0x71,0x90,0xe6,0xc1,0x28,0x8f,0x28,0x6b,0x94,0x2f,0xa6,0xc0,0xdc,
+  0xf0,0xa2,0xd9,0x62,0x4a,0x30,0x09,0x09,0xf6,0xc2,0xe5,0x72,0x36,0x8f,0x8f,0xde,0x3e,0x55,0x42,0x69,
+  0xd4,0x59,0xc6,0x44,0x69,0x06,0xda,0x77,0x5b,0xed,0x4a,0x14,0xae,0x8a,0x7d,0xb7,0x84,0xc2,0x62,0xef,
+  0x95,0x4a,0x70,0xe6,0x4d,0xd9,0x86,0x50,0xb6,0x89,0x19,0x2f,0x0b,0x81,0x0f,0x88,0x08,0x45,0x9f,0x63,
+  0xba,0xd3,0xa5,0xdd,0xa8,0x50,0x5c,0x1a,0xd0,0x71,0xb7,0xed,0x1a,0x6f,0xf1,0x13,0xc4,0x89,0x92,0xc6,
+  0x4f,0x70,0xce,0xc5,0x01,0x7d,0xd5,0x1c,0x8b,0x76,0xa5,0xe4,0x3f,0x01,0x85,0xc1,0x0a,0xf2,0xb8,0xc0,
+  0x8c,0x71,0x99,0xa2,0x20,0xb2,0x3f,0x5e,0x39,0x33,0x19,0x72,0x52,0x63,0x03,0x7b,0xe3,0x33,0xa0,0x4a,
+  0x63,0xc3,0x95,0x44,0x52,0x49,0x88,0x73,0xac,0x53,0x2e,0xd1,0xd2,0x4a,0xc2,0x3b,0x1b,0xee,0xba,0x9b,
+  0xb4,0xd6,0x65,0x86,0x99,0x7a,0x6d,0xde,0x3a,0xd1,0xee,0x39,0x85,0x10,0x56,0x36,0xbc,0xe6,0x3d,0x16,
+  0x3c,0x95,0x88,0x82,0xd3,0x59,0x07,0x3d,0x51,0x94,0xa9,0x17,0xd0,0x37,0x72,0xed,0x60,0x3a,0xae,0x1d,
+  0xe2,0xf7,0xb8,0xb6,0x96,0xa3,0x63,0x30,0x35,0xfc,0x05,0xaa,0x42,0x95,0xbc,0x09,0x48,0x83,0xc0,0x6e,
+  0x25,0x36,0xaa,0x70,0x90,0xeb,0xef,0x54,0xe0,0xb2,0xfc,0xf0,0x79,0x52,0xe6,0x58,0x88,0xc9,0x8f,0xaa,
+  0xa5,0xb1,0xb2,0x30,0x7a,0xe2,0x5c,0x3a,0x6d,0x7e,0x03,0xfe,0x68,0x4f,0x95,0x4c,0x78,0x6a,0x1d,0xee,
+  0xae,0x8d,0x27,0x42,0x22,0x9a,0x5c,0xab,0x8d,0x56,0xc7,0x76,0x39,0xab,0x83,0xf6,0xa8,0xbb,0x90,0x75,
+  0x67,0xdc,0x80,0xac,0xb5,0xac,0xbf,0xe4,0xc0,0x38,0xf6,0x94,0x14,0x07,0xaf,0xa4,0x1a,0x40,0x7a,0x58,
+  0x32,0xef,0x21,0xe7,0xd2,0x6f,0xa5,0x3c,0x6e,0xb6,0xc5,0x7e,0x5e,0x05,0x0d,0xa8,0xaa,0x2f,0x9a,0x59,
+  0x7d,0x44,0xe2,0xb6,0xd8,0xe5,0x03,0xc3,0xe8,0x3d,0x86,0xb7,0x9f,0xd5,0xee,0xd8,0xe7,0x24,0x1a,0x1f,
+  0x56,0x52,0x2c,0x80,0x0d,0x87,0x39,0x50,0x77,0xc4,0xd0,0x38,0x77,0xae,0x9f,0x8e,0x8c,0x47,0x2b,0xb5,
+  0xc0,0x04,0x44,0x75,0xfd,0x5b,0x3a,0x0d,0xb1,0x0e,0x92,0xfc,0x7f,0x36,0x8d,0xe8,0x96,0x9e,0xd1,0x4a,
+  0xfb,0x8b,0xa6,0x31,0x6e,0x19,0xeb,0xa1,0x65,0x6c,0xec,0xec,0x77,0x1d,0xe3,0x4f,0x9b,0x44,0x4f,0xf0,
+  0x1f,0x37,0x89,0xe1,0x98,0xab,0x4d,0x22,0x30,0x2a,0x4d,0x05,0x54,0x67,0x00,0x2f,0x16,0x77,0x67,0xeb,
+  0x97,0xaf,0xdc,0xd0,0xac,0xba,0x64,0x33,0xd2,0x64,0xb3,0x1a,0x01,0x24,0xf4,0xfc,0x2a,0xd8,0x5c,0x4c,
+  0xeb,0x63,0x82,0x71,0x12,0x76,0xf4,0xd7,0xce,0x26,0x03,0x9e,0x66,0xc6,0xb6,0x2b,0x3b,0x7f,0xab,0xdf,
+  0xd2,0x33,0xdc,0x96,0x7a,0xc7,0x37,0xe7,0x8c,0x09,0x1b,0x95,0xc6,0xb2,0xb3,0x3c,0x0a,0xf1,0x96,0xc1,
+  0x2a,0x2a,0xcf,0xd4,0x23,0x02,0x89,0xd2,0xb0,0x38,0x5b,0xc5,0x89,0x8d,0xbe,0xb2,0x5f,0x8c,0xb1,0x39,
+  0x40,0x93,0xc9,0x65,0xaf,0xea,0xf4,0xc6,0xba,0x2d,0x8b,0x49,0x92,0x78,0x4b,0x97,0x42,0x80,0x3e,0x7f,
+  0xa7,0xe5,0x6e,0x7b,0x0a,0x51,0xfb,0xa1,0xa0,0x3c,0x37,0x1c,0x21,0x9d,0x12,0xfc,0xb0,0x5c,0x34,0xc3,
+  0x46,0x32,0xef,0x6f,0xb5,0xe8,0x08,0xa9,0x99,0x0f,0x90,0x30,0xb1,0x50,0x77,0xa6,0x4d,0xb2,0xbd,0xd2,
+  0x62,0x01,0x89,0x69,0x26,0x23,0x3e,0x6e,0xed,0x94,0x4c,0x5b,0x93,0xde,0xe5,0x88,0xef,0x8b,0xd1,0x3d,
+  0xfb,0x18,0xaf,0x45,0x14,0xcd,0x07,0xc8,0x34,0x03,0xfa,0x6c,0x3d,0x50,0x33,0xb1,0x75,0xfe,0xf1,0x4c,
+  0xcd,0x58,0x46,0x57,0x32,0xb7,0x3b,0xf7,0xa1,0x34,0x34,0xc2,0xed,0xb1,0xf8,0x07,0xd7,0xea,0x2d,0xc2,
+  0x17,0x5e,0x72,0xc2,0x05,0x37,0x07,0x94,0xd9,0x1a,0x03,0x39,0x38,0xb5,0x4d,0xb4,0xed,0x07,0x7e,0xb3,
+  0x67,0x74,0xb1,0x52,0x5d,0x12,0xec,0xdf,0x9f,0xfa,0x17,0x2b,0xd4,0xdf,0x7d,0x73,0x09,0x00,0x00
+};
+const ProgmemAsset styles_css_asset   = {styles_css_type,styles_css,styles_css_len,(PGM_P)styles_css_gz,styles_css_gz_len,styles_css_hash};
+
@@ -21,53 +21,127 @@
  */
 
 #include "CommonProgmem.h"
+#include "UrlCodec.h"
 
 /** Leelanau Software Company namespace 
 *  
 */
 namespace lsc {
 
-URNToken URNTokenIterator::first() {
-  URNToken result;
-  if( _urn != NULL ) {
-     _next = _urn;
-     if( *_next == _delim) _next++;
-     _current  = _next;
-    int  len  = 0;
-     bool done = false;
-     while( (*_next != '\0') && !done) {
-        if( *_next != _delim ) {_next++;len++;}
-        else {_next++;done=true;}
-     }
-     result.initialize(_current, len);
+/**
+ *  Copy the token to buffer, '\0' terminated and truncated to buffLen. An empty token copies an empty string.
+ */
+void URNToken::getToken(char buffer[], size_t buffLen) const {
+  if( buffLen > 0 ) {
+    size_t len = ((_len < buffLen)?(_len):(buffLen-1));
+    if( len > 0 ) memcpy(buffer,_ptr,len);
+    buffer[len] = '\0';
+  }
+}
+
+/**
+ *  End of the token at p. URN tokens run about 9 bytes, too short for findDelim()'s word scan to repay its
+ *  alignment prologue, so they are scanned a byte at a time.
+ */
+static inline const char* tokenEnd(const char* p, char delim) {
+  while( (*p != '\0') && (*p != delim) ) p++;
+  return p;
+}
+
+/**
+ *  Single pass over the URN recording the start offset of each token, up to URN_MAX_TOKENS+1 offsets that fit in 
+ *  16 bits, and counting the rest
+ */
+void URNTokenIterator::index(const char* str, char delim) {
+  _urn   = str;
+  _delim = delim;
+  if( _urn == NULL ) return;
+  const char* p = _urn;
+  if( *p == _delim ) p++;
+  while( *p != '\0' ) {
+    size_t offset = p - _urn;
+    if( (_indexed == _count) && (_indexed <= URN_MAX_TOKENS) && (offset <= UINT16_MAX) ) _start[_indexed++] = offset;
+    _count++;
+    p = tokenEnd(p,_delim);
+    _end = p - _urn;
+    if( *p == _delim ) p++;
   }
-  return result;
 }
 
-URNToken URNTokenIterator::next() {
+URNToken URNTokenIterator::getToken(unsigned int index) const {
   URNToken result;
-  if( _next != NULL ) {
-     bool  done = false;
-     _current   = _next;
-     int len    = 0;
-     while( (*_next != '\0') && !done ) {
-        if( *_next != _delim) {_next++;len++;}
-        else {_next++;done=true;}
-     }
-     result.initialize(_current, len);
-     if( *_next == '\0') {_next = NULL;_current = NULL;}
+  if( index < _count ) {
+    const char* start = NULL;
+    if( index < _indexed ) start = _urn + _start[index];
+    else {
+      start = _urn + _start[_indexed-1];
+      for( unsigned i=_indexed-1; i<index; i++ ) {start = tokenEnd(start,_delim) + 1;}
+    }
+    const char* end = NULL;
+    if( index+1 < _indexed )     end = _urn + _start[index+1] - 1;
+    else if( index+1 == _count ) end = _urn + _end;
+    else                         end = tokenEnd(start,_delim);
+    result.initialize(start,end-start);
   }
   return result;
 }
 
-URNToken URNTokenIterator::getToken(unsigned int index) {
-   URNToken result;
-   int tknNum = 0;
-   int limit = index;
-   URNToken tkn = first();
-   while(hasNext() && (tknNum < limit)) {tknNum++;tkn = next();}
-   if( tknNum == limit) result = tkn;
-   return result;
+void BufferBuilder::reset(int pos) {
+  _pos       = ((pos < 0)?(0):(pos));
+  _length    = _pos;
+  _truncated = false;
+  if( _pos >= _size ) {_pos = ((_size > 0)?(_size-1):(0)); _truncated = true;}
+  if( _size > 0 ) _buffer[_pos] = '\0';
+}
+
+int BufferBuilder::append_P(PGM_P format, ...) {
+  va_list args;
+  va_start(args,format);
+  int result = vappend(true,format,args);
+  va_end(args);
+  return result;
+}
+
+int BufferBuilder::append(const char* format, ...) {
+  va_list args;
+  va_start(args,format);
+  int result = vappend(false,format,args);
+  va_end(args);
+  return result;
+}
+
+/**
+ *   Format at the current position and advance by the length vsnprintf reports. Once truncated, fragments are only
+ *   measured so that required() stays exact. Returns the formatted length of the fragment.
+ */
+int BufferBuilder::vappend(bool progmem, const char* format, va_list args) {
+  int n = 0;
+  if( _truncated ) n = (progmem?(vsnprintf_P(NULL,0,format,args)):(vsnprintf(NULL,0,format,args)));
+  else {
+    int avail = _size - _pos;
+    n = (progmem?(vsnprintf_P(_buffer+_pos,avail,format,args)):(vsnprintf(_buffer+_pos,avail,format,args)));
+    if( n >= avail ) {_pos = _size-1; _truncated = true;}
+    else if( n > 0 ) _pos += n;
+  }
+  if( n > 0 ) _length += n;
+  return ((n > 0)?(n):(0));
+}
+
+/**
+ *   Copy len bytes of unformatted content at the current position, with the same truncation rules as vappend().
+ *   Returns len.
+ */
+int BufferBuilder::write(bool progmem, const char* content, size_t len) {
+  if( !_truncated ) {
+    size_t n = ((len < (size_t)(_size-_pos))?(len):(_size-_pos-1));
+    if( progmem ) memcpy_P(_buffer+_pos,content,n);
+    else          memcpy(_buffer+_pos,content,n);
+    _pos += n;
+    _buffer[_pos] = '\0';
+    _truncated = (n < len);
+  }
+  _length += len;
+  return len;
 }
 
 /**
@@ -78,11 +152,12 @@ URNToken URNTokenIterator::getToken(unsigned int index) {
 int formatBuffer_P(char buffer[], int size, int pos, PGM_P format, ...) {
   int result = size;
   if( (pos >= 0) && (pos < size-1) ) {
+     BufferBuilder b(buffer,size,pos);
      va_list args;
      va_start (args, format);
-     vsnprintf_P(buffer+pos, size-pos, format, args);
+     b.vappend_P(format, args);
      va_end (args);
-     result = strlen(buffer);
+     result = b.position();
   }
   return result;
 }
@@ -95,11 +170,12 @@ int formatBuffer_P(char buffer[], int size, int pos, PGM_P format, ...) {
 int formatBuffer(char buffer[], int size, int pos, const char* format, ...) {
   int result = size;
   if( (pos >=0 ) && (pos < size-1) ) {
+     BufferBuilder b(buffer,size,pos);
      va_list args;
      va_start (args, format);
-     vsnprintf(buffer+pos, size-pos, format, args);
+     b.vappend(format, args);
      va_end (args);
-     result = strlen(buffer);
+     result = b.position();
   }
   return result;
 }
@@ -118,26 +194,65 @@ int formatHeader(char buffer[], int size, const char* title) {
 
 int formatTail( char buffer[], int size, int pos ) {return formatBuffer_P(buffer,size, pos, html_tail);}
 
-int  base64ToURL(char buffer[], int size, int pos, const char* b64Str) {
-  int result = size;
-  int strSize = strlen(b64Str);
-  int j = pos;
-  if( (pos >=0 ) && (pos < size-1) ) {
-    for(int i=0; (j<size)&&(i<strSize); i++) {
-       if(b64Str[i] == '=')  {buffer[j++]='%';buffer[j++]='3';buffer[j++]='D';}     
-       else if(b64Str[i] == '+')  {buffer[j++]='%';buffer[j++]='2';buffer[j++]='B';}
-       else buffer[j++] = b64Str[i];
-    }
-    if( j<size ) {
-      buffer[j] = '\0';
-      result = j;
-    }
-    else {
-      buffer[size-1] = '\0';
-      result = size-1;
+/**
+ *   Base64 characters are all unreserved except '+', '/' and '=', so urlEncode() escapes exactly those
+ */
+int  base64ToURL(char buffer[], int size, int pos, const char* b64Str) {return urlEncode(buffer,size,pos,b64Str);}
+
+#if defined(__SANITIZE_ADDRESS__) && !defined(COMMON_SCAN_BYTEWISE)
+#define COMMON_SCAN_BYTEWISE                     // Word reads may pass the end of the allocation, which ASan reports
+#endif
+#if defined(__has_feature) && !defined(COMMON_SCAN_BYTEWISE)
+#if __has_feature(address_sanitizer)
+#define COMMON_SCAN_BYTEWISE
+#endif
+#endif
+
+/**
+ *   SWAR scan: a word holds a zero byte iff ((w - ones) & ~w & highs) is non zero, so a word is tested for '\0' and
+ *   for delim (a zero byte in w ^ (delim * ones)) together. Words are read with memcpy from aligned addresses only,
+ *   which never crosses a page boundary past the terminator. The lowest flagged byte of a hit word is always a true
+ *   match, so little endian targets take it with ctz, and others rescan the hit word bytewise.
+ */
+const char* findDelim(const char* str, char delim) {
+  const char* p = str;
+#ifndef COMMON_SCAN_BYTEWISE
+  typedef uintptr_t word_t;
+  const word_t ones  = ((word_t)-1)/0xFF;
+  const word_t highs = ones << 7;
+  const word_t mask  = ones * (uint8_t)delim;
+  while( ((uintptr_t)p & (sizeof(word_t)-1)) != 0 ) {
+    if( (*p == '\0') || (*p == delim) ) return p;
+    p++;
+  }
+  for( ;; p += sizeof(word_t) ) {
+    word_t w;
+    memcpy(&w,p,sizeof(w));
+    word_t d    = w ^ mask;
+    word_t hits = (((w - ones) & ~w) | ((d - ones) & ~d)) & highs;
+    if( hits != 0 ) {
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+      return p + (__builtin_ctzll(hits) >> 3);
+#else
+      break;
+#endif
     }
   }
-  return result;   
+#endif
+  while( (*p != '\0') && (*p != delim) ) p++;
+  return p;
+}
+
+uint32_t fnv1a(const char* data, size_t len) {
+  uint32_t result = 2166136261UL;
+  for( size_t i=0; i<len; i++ ) {result ^= (uint8_t)data[i]; result *= 16777619UL;}
+  return result;
+}
+
+uint32_t fnv1a_P(PGM_P data, size_t len) {
+  uint32_t result = 2166136261UL;
+  for( size_t i=0; i<len; i++ ) {result ^= pgm_read_byte(data+i); result *= 16777619UL;}
+  return result;
 }
 
 const char*  _stackStart = NULL;
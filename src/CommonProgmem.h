@@ -22,7 +22,11 @@
 
 #ifndef COMMON_PROGMEM_H
 #define COMMON_PROGMEM_H
+#ifdef ARDUINO
 #include <Arduino.h>
+#else
+#include "HostPlatform.h"
+#endif
 
 #include "CommonDef.h"
 
@@ -31,15 +35,30 @@
 */
 namespace lsc {
 
+#ifndef URN_MAX_TOKENS
+#define URN_MAX_TOKENS   16                      // Token offsets held by URNTokenIterator, later tokens are found by scanning
+#endif
+
+/**
+ *   URNToken is a view of a token in a URN, a pointer and length into the URN string, and is trivially copyable.
+ *   Tokens can be compared against literals in place, or copied out '\0' terminated with getToken().
+ */
 class URNToken {
     public:
     URNToken()                                          {}
     URNToken(const char* ptr, size_t len)               {initialize(ptr,len);}
-    URNToken(const URNToken& ref)                       {initialize(ref._ptr,ref._len);}
-    virtual ~URNToken()                                 {}
 
     void initialize(const char* ptr, size_t len)        {_ptr = ptr; _len=len;}
-    void getToken(char buffer[], size_t buffLen) const  {size_t len=((_len+1<buffLen)?(_len+1):(buffLen));if(_ptr!=NULL) strlcpy(buffer,_ptr,len);}
+    void getToken(char buffer[], size_t buffLen) const;
+    const char* ptr() const                             {return _ptr;}
+    size_t      length() const                          {return _len;}
+    bool        isEmpty() const                         {return _len == 0;}
+
+    bool        equals(const char* s) const             {return (s != NULL) && ((_len == 0) || (strncmp(_ptr,s,_len) == 0)) && (s[_len] == '\0');}
+    bool        equalsIgnoreCase(const char* s) const   {return (s != NULL) && ((_len == 0) || (strncasecmp(_ptr,s,_len) == 0)) && (s[_len] == '\0');}
+    bool        startsWith(const char* s) const         {size_t n = ((s != NULL)?(strlen(s)):(0)); return (n == 0) || ((n <= _len) && (strncmp(_ptr,s,n) == 0));}
+    bool        operator==(const char* s) const         {return equals(s);}
+    bool        operator!=(const char* s) const         {return !equals(s);}
 
     private:    
     const char*    _ptr   = NULL;
@@ -55,29 +74,79 @@ class URNToken {
  *   URNTokenIterator will iterate through the tokens in the URN returning "urn", "LeelanauSoftware-com", "device", "RelayControl", and "1", 
  *   in that order. It is assumed the URN has the above form, so leading and trailing ':' are ignored. Note that while URN requires ':' as 
  *   a delimeter, URNTokenIterator can be configured to use any single character as delimeter.
- *   Note: hasNext() will return false until first() is called, and will return true until end of line is reached.
+ *   The URN is scanned once, on construction, into a table of token offsets, so size(), getToken() and operator[] do not rescan it:
+ *      URNTokenIterator it(st);
+ *      if( (it.size() == 5) && (it[2] == "device") && it[3].equals("RelayControl") ) ...
+ *   Note: hasNext() will return false until first() is called, and will return true until the last token has been returned.
  */
 class URNTokenIterator {
     public:
-    URNTokenIterator(const char* str)                 {_urn = str;}
-    URNTokenIterator(const char* str, char delim)     {_urn = str; _delim = delim;}
-    virtual ~URNTokenIterator() {}
+    URNTokenIterator(const char* str)                 {index(str,':');}
+    URNTokenIterator(const char* str, char delim)     {index(str,delim);}
 
-    bool     hasNext()                                {return _next != NULL;}
-    URNToken first();
-    URNToken next();
-    URNToken getToken(unsigned int index);
-    URNToken operator[](unsigned int index)          {return getToken(index);}
+    bool     hasNext() const                          {return (_cursor > 0) && (_cursor < _count);}
+    URNToken first()                                  {_cursor = 1; return getToken(0);}
+    URNToken next()                                   {return ((hasNext())?(getToken(_cursor++)):(URNToken()));}
+    URNToken getToken(unsigned int index) const;
+    URNToken operator[](unsigned int index) const     {return getToken(index);}
+    unsigned size() const                             {return _count;}
 
     private:
+    void            index(const char* str, char delim);
+
     const char*     _urn     = NULL;
-    const char*     _current = NULL;
-    const char*     _next    = NULL;
     char            _delim   = ':';
+    unsigned        _count   = 0;
+    unsigned        _cursor  = 0;
+    unsigned        _indexed = 0;                    // Number of entries in _start
+    size_t          _end     = 0;                    // Offset of the end of the last token
+    uint16_t        _start[URN_MAX_TOKENS+1];
 
     URNTokenIterator() {}
 };
 
+/**
+ *   BufferBuilder formats into a caller supplied char buffer, tracking the write position from the return value of 
+ *   vsnprintf, so each append costs only the bytes it writes rather than a rescan of the whole buffer. 
+ *   When an append does not fit the builder becomes truncated: the buffer keeps everything that fit, '\0' terminated,
+ *   later appends are measured but not written, and required() reports the buffer size needed for the complete 
+ *   output, so a caller can retry once with an exact size buffer. For example:
+ *     char buffer[1000];
+ *     BufferBuilder b(buffer,sizeof(buffer));
+ *     b.append_P(html_header);
+ *     b.append_P(html_title,"Nearby Devices");
+ *     if( b.truncated() ) Serial.printf("Page needs %d bytes\n",b.required());
+ */
+class BufferBuilder {
+    public:
+    BufferBuilder(char buffer[], int size, int pos=0)  {_buffer = buffer; _size = size; reset(pos);}
+
+    int      append_P(PGM_P format, ...);
+    int      append(const char* format, ...);
+    int      vappend_P(PGM_P format, va_list args)    {return vappend(true,format,args);}
+    int      vappend(const char* format, va_list args) {return vappend(false,format,args);}
+    int      write(const char* content, size_t len)    {return write(false,content,len);}
+    int      write_P(PGM_P content, size_t len)         {return write(true,content,len);}
+    void     reset(int pos=0);
+
+    int      position() const                          {return _pos;}
+    bool     truncated() const                         {return _truncated;}
+    int      required() const                          {return _length+1;}
+    const char* c_str() const                          {return _buffer;}
+
+    private:
+    int      vappend(bool progmem, const char* format, va_list args);
+    int      write(bool progmem, const char* content, size_t len);
+
+    char*    _buffer    = NULL;
+    int      _size      = 0;
+    int      _pos       = 0;
+    int      _length    = 0;
+    bool     _truncated = false;
+
+    BufferBuilder() {}
+};
+
 /** Helper functions to fill buffer with HTML from templates.
  *  For example:
  *    char buffer[1500];
@@ -87,6 +156,8 @@ class URNTokenIterator {
  *    pos = formatBuffer(buffer,size,pos,template2,b1,b2...bN);
  *    formatTail(buffer,size,pos);
  *  
+ *  Each returns the updated position, which is size-1 if the buffer is full. Use BufferBuilder directly when
+ *  a caller needs to distinguish truncation from an exact fill.
  */
 extern int  formatBuffer_P(char buffer[], int size, int pos, PGM_P format, ...);
 extern int  formatBuffer(char buffer[], int size, int pos, const char* format, ...);
@@ -94,11 +165,27 @@ extern int  formatHeader(char buffer[], int size, const char* title);
 extern int  formatTail(char buffer[], int size, int pos);
 
 /**
- *  URL Encode a base64 character string, replacing '=' with "%3D" and '+' with "%20"
- *  The resulting buffer is '\0' terminated, truncating encoding if buffer size is exceeded.
+ *  URL Encode a base64 character string, replacing '+' with "%2B", '/' with "%2F" and '=' with "%3D".
+ *  The resulting buffer is '\0' terminated, truncated at a whole escape if buffer size is exceeded.
+ *  Equivalent to urlEncode(buffer,size,pos,b64Str), see UrlCodec.h.
  */
 extern int  base64ToURL(char buffer[], int size, int pos, const char* b64Str);  
 
+/**
+ *  Return a pointer to the first delim in str, or to its terminating '\0' if there is none. Once str is word
+ *  aligned it tests a word at a time for both delim and '\0', so str may be unaligned. That pays off only when the
+ *  runs between delimiters are long, around 200 bytes or more; URNTokenIterator and RouteTable, with tokens of
+ *  about 9 bytes, scan a byte at a time, and HttpParser knows its lengths and uses memchr(). Define COMMON_SCAN_BYTEWISE to test one byte at a time,
+ *  as AddressSanitizer builds do.
+ */
+extern const char* findDelim(const char* str, char delim);
+
+/**
+ *  32 bit FNV-1a hash of len bytes of data, with fnv1a_P reading data from PROGMEM.
+ */
+extern uint32_t fnv1a(const char* data, size_t len);
+extern uint32_t fnv1a_P(PGM_P data, size_t len);
+
 /**   Stack Memory checking
  *    
  */
@@ -113,168 +200,50 @@ extern int  stackUsed(const char* c);
 extern void reportStackUse(const char* msg,const char* c);
 
 /** Templates for filling char buffers
- * 
+ *  Templates are constexpr so they can also be parsed at compile time by HtmlTemplate (see HtmlTemplate.h)
  */
-const char error_html[]    PROGMEM = "<?xml version=\"1.0\" encoding=\"UTF-8\"?><error>%s Not Found</error>";                                       
+constexpr char error_html[]    PROGMEM = "<?xml version=\"1.0\" encoding=\"UTF-8\"?><error>%s Not Found</error>";                                       
 const char TEXT_HTML[]     PROGMEM = "text/html";
 const char TEXT_CSS[]      PROGMEM = "text/css";
-const char html_header[]   PROGMEM = "<!DOCTYPE html><html><meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"
+const char TEXT_PLAIN[]    PROGMEM = "text/plain";
+constexpr char html_header[]   PROGMEM = "<!DOCTYPE html><html><meta name=\"viewport\" content=\"width=device-width, initial-scale=1.0\">"
                                         "<head><link rel=\"stylesheet\" type=\"text/css\" href=\"/styles.css\"></head>"
                                         "<body style=\"font-family: Arial\">";
-const char html_title[]    PROGMEM = "<H1 style=\"text-align: center\"> %s </H1><br>";
-const char html_L2_title[] PROGMEM = "<H2 style=\"text-align: center\"> %s </H2>";
-const char html_L3_title[] PROGMEM = "<H3 style=\"text-align: center\"> %s </H3>";
-const char html_tail[]     PROGMEM = "</body></html>";
-const char iframe_html[]   PROGMEM = "<div align=\"center\"><iframe src=\"%s\" height=\"%d\" width=\"%d\" style=\"border:none;\"></iframe></div>";
-const char html_NotFound[] PROGMEM = "<!DOCTYPE html><html><body style=\"font-family: Calibri\"><h1 align=\"center\"> OOPS! %s Not Found!</h1></body></html>"; //URI
-const char nearby_html[]   PROGMEM = "<a href=\"/%s/nearbyDevices\" class=\"scaled apButton\">Nearby Devices</a>";
-const char app_button[]    PROGMEM = "<a href=\"%s\" class=\"scaled apButton\">%s</a>";
-const char small_button[]  PROGMEM = "<a href=\"%s\" class=\"small apButton\">%s</a>";
+constexpr char html_title[]    PROGMEM = "<H1 style=\"text-align: center\"> %s </H1><br>";
+constexpr char html_L2_title[] PROGMEM = "<H2 style=\"text-align: center\"> %s </H2>";
+constexpr char html_L3_title[] PROGMEM = "<H3 style=\"text-align: center\"> %s </H3>";
+constexpr char html_tail[]     PROGMEM = "</body></html>";
+constexpr char iframe_html[]   PROGMEM = "<div align=\"center\"><iframe src=\"%s\" height=\"%d\" width=\"%d\" style=\"border:none;\"></iframe></div>";
+constexpr char html_NotFound[] PROGMEM = "<!DOCTYPE html><html><body style=\"font-family: Calibri\"><h1 align=\"center\"> OOPS! %s Not Found!</h1></body></html>"; //URI
+constexpr char nearby_html[]   PROGMEM = "<a href=\"/%s/nearbyDevices\" class=\"scaled apButton\">Nearby Devices</a>";
+constexpr char app_button[]    PROGMEM = "<a href=\"%s\" class=\"scaled apButton\">%s</a>";
+constexpr char small_button[]  PROGMEM = "<a href=\"%s\" class=\"small apButton\">%s</a>";
 
 /**
  *   Note that a config apButton is a scaled apButton with different colors
  */
-const char config_button[] PROGMEM = "<a href=\"%s\" class=\"config apButton\">%s</a>";
+constexpr char config_button[] PROGMEM = "<a href=\"%s\" class=\"config apButton\">%s</a>";
 
 /**
- *   Note that styles_css is intended to be sent directly without formating, so the "%" characters are not escaped. 
- */   
-const char styles_css[]    PROGMEM = ".apButton {"
-                "background:linear-gradient(to bottom, #ededed 5%, #bab1ba 100%);"
-                "background-color:#ededed;"
-                "border-radius:12px;"
-                "border:1px solid #d6bcd6;"
-                "display:block;"
-                "cursor:pointer;"
-                "color:#3a8a9e;"
-                "font-family:Arial;"
-                "font-size: 1.2em;"  
-                "padding: .5em;"
-                "width: 100%;"
-                "text-decoration:none;"
-                "margin: 0px auto 3px auto;"                                                 
-                "text-shadow:0px 1px 0px #e1e2ed;"
-                "text-align: center;"
-              "}"
-              ".apButton:hover {"
-                "background:linear-gradient(to bottom, #bab1ba 5%, #ededed 100%);"
-                "background-color:#bab1ba;"
-              "}"
-              ".apButton:active {"
-                "position:relative;"
-                "top:1px;"
-              "}" 
-              "[class*=\"small\"]  {"
-                "width: 20% ;"
-                "display: inline-block ;"
-              "}"                    
-              "[class*=\"config\"]  {" 
-                 "background:linear-gradient(to bottom, #ededed 5%, #9bb5cf 100%);"  
-                 "background-color:#ededed;"
-                 "width: 80% ;"                    
-              "}" 
-              ".config:hover {"
-                  "background:linear-gradient(to bottom, #9bb5cf 5%, #ededed 100%);"
-                  "background-color:#9bb5cf;" 
-              "}"                    
-              "@media only screen and (min-width: 768px) {"
-                ".small  {width: 10%;}"                       
-             "}"
-              "[class*=\"medium\"]  {"
-                "width: 50% ;"
-                "display: inline-block ;"
-              "}"                    
-              "@media only screen and (min-width: 768px) {"
-                ".medium {width: 25%;}"  
-              "}"
-              "[class*=\"scaled\"] {"
-                "width: 80% ;"                    
-             "}"
-              "@media only screen and (min-width: 768px) {"
-                ".scaled {width: 40%;}"
-                ".config {width: 40%;}"                       
-              "}"
-              "label {" 
-                "font-family: Arial;"                
-                "font-size: 1.2em;"
-                "display: inline;"
-              "}"
-              ".fmButton {"
-                 "background:linear-gradient(to bottom, #ededed 5%, #bab1ba 100%);"
-                 "background-color:#ededed;" 
-                 "border-radius:5px;"
-                 "border:1px solid #d6bcd6;"
-                 "display: inline;"  
-                 "cursor:pointer;"
-                 "color:#3a8a9e;"
-                 "font-family:Arial;"
-                 "font-size: 1em;"  
-                 "padding: .3em;"
-                 "width: 6em;"
-                 "text-decoration:none;"
-                 "margin: auto;"
-                 "text-shadow:0px 1px 0px #e1e2ed;"
-                 "text-align: center;"
-               "}"
-               ".fmButton:hover {"
-                 "background:linear-gradient(to bottom, #bab1ba 5%, #ededed 100%);"
-                 "background-color:#bab1ba;"
-               "}"
-               ".fmButton:active {"
-                 "position:relative;"
-                 "top:1px;"
-               "}"
-               ".toggle {"
-               "  cursor: pointer;"
-               "  display: inline-block;"
-               "}"
-               ".toggle-switch {"
-               "  display: inline-block;"
-               "  background: #e5eefc;"
-               "  border-radius: 16px;"
-               "  border: 1px solid #7faaf1;"
-               "  width: 36px;"
-               "  height: 20px;"
-               "  position: relative;"
-               "  vertical-align: middle;"
-               "  transition: background 0.25s;"
-               "}"
-               ".toggle-switch:before, .toggle-switch:after {"  
-               "  content: \"\";"
-               "}"
-               ".toggle-switch:before {"
-               "  display: block;"
-               "  background: linear-gradient(to bottom, #fff 0%, #eee 100%);"
-               "  border-radius: 50%;"
-               "  box-shadow: 0 0 0 1px rgba(0, 0, 0, 0.25);"
-               "  width: 15px;"
-               "  height: 15px;"
-               "  position: absolute;"
-               "  top: 3px;"
-               "  left: 3px;"
-               "  transition: left 0.25s;"
-               "}"
-               ".toggle:hover .toggle-switch:before {"
-               "  background: linear-gradient(to bottom, #fff 0%, #fff 100%);"
-               "  box-shadow: 0 0 0 1px rgba(0, 0, 0, 0.5);"
-               "}"
-               ".toggle-checkbox:checked + .toggle-switch {"
-               "  background: #7faaf1;"
-               "}"
-               ".toggle-checkbox:checked + .toggle-switch:before {"
-               "  left: 18px;"
-               "}"
-               ".toggle-checkbox {"
-               "  position: absolute;"
-               "  visibility: hidden;"
-               "}"
-               ".toggle-label {"
-               "  margin-left: 5px;"
-               "  position: relative;"
-               "  top: 2px;"
-               "}";
-               
-const char loc_template[]  PROGMEM = "http://%d.%d.%d.%d:%d";
+ *   A PROGMEM asset with its gzip compressed form, for WebContext::serveStatic_P(). gzip is NULL when there is no
+ *   compressed form. hash is FNV-1a over content, so it can be used as an ETag without reading the asset.
+ */
+struct ProgmemAsset {
+  PGM_P    contentType;
+  PGM_P    content;
+  size_t   length;
+  PGM_P    gzip;
+  size_t   gzipLength;
+  uint32_t hash;
+};
+
+/**
+ *   Minified and gzip compressed assets generated from extras/assets by make assets in extras/host, styles_css among
+ *   them. styles_css is intended to be sent directly without formating, so the "%" characters are not escaped.
+ */
+#include "CommonAssets.h"
+
+constexpr char loc_template[]  PROGMEM = "http://%d.%d.%d.%d:%d";
 
 } // End of namespace lsc
 
@@ -21,6 +21,12 @@
  */
 
 #include "WebContext.h"
+#include "StaticWebContext.h"
+#include "ResponseWriter.h"
+#include "HtmlTemplate.h"
+#include "HtmlPage.h"
+#include "UrlCodec.h"
+#include "Logger.h"
 #include "CommonProgmem.h"
 #include "CommonDef.h"
 
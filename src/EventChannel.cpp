@@ -0,0 +1,148 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "EventChannel.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+/**
+ *   Bytes client can take without blocking. ESP32's WiFiClient does not report it, and is written at most one event
+ *   per call.
+ */
+static size_t writable(WiFiClient& client) {
+#ifdef ESP32
+  return EVENT_MAX_LENGTH;
+#else
+  return client.availableForWrite();
+#endif
+}
+
+/**
+ *   Format as id, event and one data field per line, and copy into the next slot of the ring only once it is known
+ *   to fit, so an event too long leaves the oldest one whole. Then move each subscriber the ring would overrun on
+ *   to its oldest event still held.
+ */
+bool EventChannel::send(const char* data, const char* event) {
+  if( data == NULL ) data = "";
+  char   buffer[EVENT_MAX_LENGTH];
+  size_t size   = EVENT_MAX_LENGTH;
+  int    len    = snprintf(buffer,size,"id: %lu\n",(unsigned long)_seq);
+  if( event != NULL ) len += snprintf(buffer+len,size-len,"event: %s\n",event);
+  if( (size_t)len >= size ) return false;
+  const char* line = data;
+  do {
+    const char* end = strchr(line,'\n');
+    size_t      n   = ((end != NULL)?(end-line):(strlen(line)));
+    if( (size_t)len + n + 8 >= size ) return false;
+    memcpy(buffer+len,"data: ",6);
+    memcpy(buffer+len+6,line,n);
+    len += 6 + n;
+    buffer[len++] = '\n';
+    line = ((end != NULL)?(end+1):(NULL));
+  } while( line != NULL );
+  if( (size_t)len + 1 >= size ) return false;
+  buffer[len++] = '\n';
+  memcpy(_events[_seq % EVENT_QUEUE],buffer,len);
+  _lengths[_seq % EVENT_QUEUE] = len;
+  _seq++;
+
+  unsigned long now = millis();
+  for( Subscriber& s : _subscribers ) {
+    if( !s.active ) continue;
+    if( _seq - s.next > EVENT_QUEUE ) {
+      _dropped += _seq - EVENT_QUEUE - s.next;
+      s.next    = _seq - EVENT_QUEUE;
+    }
+    flush(s,now);
+  }
+  return true;
+}
+
+bool EventChannel::subscribe(WiFiClient client, const char* lastEventId) {
+  if( full() ) return false;
+  Subscriber* s = _subscribers;
+  while( s->active ) s++;
+  s->client    = client;
+  s->active    = true;
+  s->next      = _seq;
+  s->lastWrite = millis();
+  s->checked   = s->lastWrite;
+  if( (lastEventId != NULL) && (*lastEventId != '\0') ) {
+    uint32_t next = strtoul(lastEventId,NULL,10) + 1;
+    if( (_seq - next) < EVENT_QUEUE ) s->next = next;
+  }
+  _count++;
+  char head[160];
+  int  len = snprintf(head,sizeof(head),"HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nCache-Control: no-cache\r\n"
+                                        "Connection: keep-alive\r\n\r\nretry: %d\n\n",EVENT_RETRY);
+  s->client.setNoDelay(true);
+  if( s->client.write((const uint8_t*)head,len) != (size_t)len ) reap(*s);
+  else                                                           flush(*s,s->lastWrite);
+  return true;
+}
+
+void EventChannel::poll() {
+  if( _count == 0 ) return;
+  unsigned long now = millis();
+  for( Subscriber& s : _subscribers ) {if( s.active ) flush(s,now);}
+}
+
+/**
+ *   Write whole events while the connection has room for them, so a subscriber never holds a partial event. An
+ *   idle subscriber is sent a heartbeat, and one with no room checked for a closed connection, once per heartbeat
+ *   interval.
+ */
+void EventChannel::flush(Subscriber& s, unsigned long now) {
+  size_t room = ((s.next != _seq)?(writable(s.client)):(0));
+  while( s.next != _seq ) {
+    size_t len = _lengths[s.next % EVENT_QUEUE];
+    if( room < len ) {
+      if( (now - s.lastWrite > EVENT_STALL) || ((now - s.checked >= _heartbeat) && !s.client.connected()) ) reap(s);
+      else if( now - s.checked >= _heartbeat ) s.checked = now;
+      return;
+    }
+    if( s.client.write((const uint8_t*)_events[s.next % EVENT_QUEUE],len) != len ) {reap(s); return;}
+    s.next++;
+    s.lastWrite = now;
+    room       -= len;
+  }
+  if( (now - s.lastWrite >= _heartbeat) ) {
+    if( !s.client.connected() || (writable(s.client) < 3) || (s.client.write((const uint8_t*)":\n\n",3) != 3) ) reap(s);
+    else s.lastWrite = now;
+  }
+}
+
+void EventChannel::drop(Subscriber& s) {
+  s.client.stop();
+  s.client = WiFiClient();
+  s.active = false;
+  _count--;
+}
+
+void EventChannel::close() {
+  for( Subscriber& s : _subscribers ) {if( s.active ) drop(s);}
+}
+
+} // End of namespace lsc
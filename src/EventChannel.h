@@ -0,0 +1,138 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Server-Sent Events channel, pushing events from the application to every browser subscribed to it over a long
+ *  lived text/event-stream response, so a dashboard is updated as device state changes rather than by polling:
+ *
+ *    EventChannel* status = ctx.sse("/status/events");
+ *    ...
+ *    status->send("{\"relay\":\"on\"}","relay");          // From loop(), whenever state changes
+ *
+ *  and in the page, new EventSource("/status/events").addEventListener("relay",...). send() formats the event once
+ *  into a ring of the last EVENT_QUEUE events, shared by all subscribers, and returns without waiting on any of
+ *  them. Each subscriber only keeps its place in the ring, and is written whole events as its connection has room,
+ *  from send() and from poll(), which WebContext::handleClient() calls. A subscriber more than EVENT_QUEUE events
+ *  behind loses the oldest, counted by dropped(). Events carry their sequence number as id, so a browser that
+ *  reconnects with Last-Event-ID resumes where it left off if its next event is still in the ring.
+ *
+ *  Idle subscribers are sent a comment every EVENT_HEARTBEAT ms, keeping proxies from closing the stream, and
+ *  subscribers that have closed, fail a write, or take nothing for EVENT_STALL ms are dropped. Memory is fixed: the
+ *  ring and EVENT_MAX_CLIENTS subscribers per channel, with no allocation after construction.
+ */
+
+#ifndef EVENT_CHANNEL_H
+#define EVENT_CHANNEL_H
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#ifdef ESP8266
+#include <ESP8266WiFi.h>
+#elif defined(ESP32)
+#include <WiFi.h>
+#endif
+#else
+#include "HostPlatform.h"
+#endif
+
+#ifndef EVENT_MAX_CLIENTS
+#define EVENT_MAX_CLIENTS    4                   // Subscribers per channel
+#endif
+#ifndef EVENT_QUEUE
+#define EVENT_QUEUE          8                   // Events kept for subscribers, the oldest dropped first
+#endif
+#ifndef EVENT_MAX_LENGTH
+#define EVENT_MAX_LENGTH     256                 // Formatted event, including id, event and data fields
+#endif
+#ifndef EVENT_HEARTBEAT
+#define EVENT_HEARTBEAT      15000               // ms idle before a heartbeat comment
+#endif
+#ifndef EVENT_STALL
+#define EVENT_STALL          30000               // ms a subscriber may take nothing with events waiting
+#endif
+#define EVENT_RETRY          3000                // ms a browser waits before reconnecting
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+class EventChannel {
+  public:
+  EventChannel()                                                 {}
+  ~EventChannel()                                                {close();}
+
+/**
+ *   Send event, with name event or none if NULL, to every subscriber. Lines of data are sent as separate data
+ *   fields. Returns false, sending nothing, if the event does not fit EVENT_MAX_LENGTH.
+ */
+  bool           send(const char* data, const char* event=NULL);
+
+/**
+ *   Write the response head to client and add it as a subscriber, from the event after lastEventId where the ring
+ *   still holds it. Returns false, leaving client as it is, if the channel is full.
+ */
+  bool           subscribe(WiFiClient client, const char* lastEventId=NULL);
+  bool           full() const                                    {return _count == EVENT_MAX_CLIENTS;}
+
+/**
+ *   Write waiting events and heartbeats without blocking, and drop dead subscribers
+ */
+  void           poll();
+  void           close();
+
+  int            clients() const                                 {return _count;}
+  unsigned long  sent() const                                    {return _seq;}
+  unsigned long  dropped() const                                 {return _dropped;}
+  unsigned long  reaped() const                                  {return _reaped;}
+  void           setHeartbeat(unsigned long ms)                  {_heartbeat = ms;}
+
+  private:
+  struct Subscriber {
+    WiFiClient     client;
+    bool           active    = false;
+    uint32_t       next      = 0;                                // Sequence number of the next event to write
+    unsigned long  lastWrite = 0;
+    unsigned long  checked   = 0;                                // Last check for a closed connection
+  };
+
+  void           flush(Subscriber& s, unsigned long now);
+  void           drop(Subscriber& s);
+  void           reap(Subscriber& s)                             {drop(s); _reaped++;}
+
+  char           _events[EVENT_QUEUE][EVENT_MAX_LENGTH];
+  uint16_t       _lengths[EVENT_QUEUE];
+  uint32_t       _seq       = 0;                                 // Sequence number of the next event sent
+  Subscriber     _subscribers[EVENT_MAX_CLIENTS];
+  int            _count     = 0;
+  unsigned long  _dropped   = 0;
+  unsigned long  _reaped    = 0;
+  unsigned long  _heartbeat = EVENT_HEARTBEAT;
+  EventChannel*  _next      = NULL;                              // Channels of a WebContext
+  friend class   WebContext;
+
+  EventChannel(const EventChannel&) = delete;
+  EventChannel& operator=(const EventChannel&) = delete;
+};
+
+} // End of namespace lsc
+
+#endif
@@ -0,0 +1,147 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "HandlerProfile.h"
+#include "Logger.h"
+#include <alloca.h>
+
+#if defined(ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+#if defined(LSC_HOST) || defined(ESP32)
+#include <mutex>
+static std::mutex profileLock;
+#define PROFILE_LOCK   std::lock_guard<std::mutex> lock(profileLock)
+#else
+#define PROFILE_LOCK
+#endif
+
+/**
+ *  Stack painting reads stack the sanitizer has already released, so sanitizer builds profile heap only
+ */
+#if defined(__SANITIZE_ADDRESS__) && !defined(HANDLER_PROFILE_HEAP_ONLY)
+#define HANDLER_PROFILE_HEAP_ONLY
+#endif
+#if defined(__has_feature) && !defined(HANDLER_PROFILE_HEAP_ONLY)
+#if __has_feature(address_sanitizer)
+#define HANDLER_PROFILE_HEAP_ONLY
+#endif
+#endif
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+long heapInUse() {
+#if defined(LSC_HOST)
+  return (long)hostHeapInUse();
+#else
+  return -(long)ESP.getFreeHeap();
+#endif
+}
+
+/**
+ *  Stack below the current frame that has never been used, so it can be painted without touching live data
+ */
+static size_t stackHeadroom() {
+#if defined(LSC_HOST)
+  return HANDLER_PROFILE_STACK_BYTES + 2*HANDLER_PROFILE_STACK_MARGIN;
+#elif defined(ESP32)
+  return uxTaskGetStackHighWaterMark(NULL);
+#else
+  return ESP.getFreeContStack();
+#endif
+}
+
+/**
+ *  Fill len bytes below the caller's frame, returning the lowest painted address. The area is released on return
+ *  and becomes the stack of the next call.
+ */
+static uintptr_t paintStack(size_t len) __attribute__((noinline));
+static uintptr_t paintStack(size_t len) {
+  char* area = (char*)alloca(len);
+  memset(area,HANDLER_PROFILE_PAINT,len);
+  __asm__ __volatile__("" : : "r"(area) : "memory");
+  return (uintptr_t)area;
+}
+
+/**
+ *  Lowest address at or above low that no longer holds the fill byte
+ */
+static uintptr_t touchedStack(uintptr_t low, size_t len) __attribute__((noinline));
+static uintptr_t touchedStack(uintptr_t low, size_t len) {
+  const volatile unsigned char* p = (const volatile unsigned char*)low;
+  size_t i = 0;
+  while( (i < len) && (p[i] == HANDLER_PROFILE_PAINT) ) i++;
+  return low + i;
+}
+
+ProfileScope::ProfileScope(HandlerProfile* profile) {
+  _profile  = profile;
+  _stackTop = (uintptr_t)__builtin_frame_address(0);
+#ifndef HANDLER_PROFILE_HEAP_ONLY
+  size_t headroom = stackHeadroom();
+  _stackLen = ((headroom > 2*HANDLER_PROFILE_STACK_MARGIN)?(headroom - 2*HANDLER_PROFILE_STACK_MARGIN):(0));
+  if( _stackLen > HANDLER_PROFILE_STACK_BYTES ) _stackLen = HANDLER_PROFILE_STACK_BYTES;
+  if( _stackLen > 0 ) _stackLow = paintStack(_stackLen);
+#endif
+  _heapStart = heapInUse();
+  _heapPeak  = _heapStart;
+}
+
+void ProfileScope::sampleHeap() {
+  long used = heapInUse();
+  if( used > _heapPeak ) _heapPeak = used;
+}
+
+void ProfileScope::end() {
+  sampleHeap();
+  long   delta = heapInUse() - _heapStart;
+  size_t depth = 0;
+  bool   saturated = false;
+  if( _stackLen > 0 ) {
+    uintptr_t touched = touchedStack(_stackLow,_stackLen);
+    depth     = ((touched < _stackTop)?(_stackTop - touched):(0));
+    saturated = (touched == _stackLow);
+  }
+  PROFILE_LOCK;
+  HandlerProfile& p = *_profile;
+  p.calls++;
+  if( depth > p.stackPeak ) p.stackPeak = depth;
+  if( (_stackLen > 0) && ((p.stackPainted == 0) || (_stackLen < p.stackPainted)) ) p.stackPainted = _stackLen;
+  p.stackSaturated = p.stackSaturated || saturated;
+  if( _heapPeak - _heapStart > p.heapPeak ) p.heapPeak = _heapPeak - _heapStart;
+  if( delta > p.heapDelta ) p.heapDelta = delta;
+  p.heapRetained += delta;
+  if( saturated ) LOG_WARNING("%s used all %u bytes of painted stack",p.route,(unsigned)_stackLen);
+  else if( (_stackLen > 0) && (stackHeadroom() < HANDLER_PROFILE_STACK_MARGIN) ) LOG_WARNING("%s left %u bytes of stack",p.route,(unsigned)stackHeadroom());
+}
+
+HandlerProfile profileSnapshot(const HandlerProfile& p) {
+  PROFILE_LOCK;
+  return p;
+}
+
+} // End of namespace lsc
@@ -0,0 +1,104 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Stack and heap high water marks of WebContext handlers, kept per route once profiling is enabled with
+ *  WebContext::enableProfiling(). Before each profiled call the free stack below the dispatch frame is painted
+ *  with a fill byte, up to HANDLER_PROFILE_STACK_BYTES and never past the thread's own recorded headroom, and after
+ *  the call the deepest overwritten byte gives the handler's peak stack depth. Heap in use is read at entry, at
+ *  each send and at exit, giving the peak a handler reached while building its page and the bytes it kept after
+ *  returning. For example:
+ *
+ *    ctx.enableProfiling();
+ *    ...
+ *    HandlerProfile worst[4];
+ *    int n = ctx.worstHandlers(worst,4);
+ *    for( int i=0; i<n; i++ ) Serial.printf("%s %u bytes of stack\n",worst[i].route,(unsigned)worst[i].stackPeak);
+ *
+ *  Painting costs a memset of the painted area per request, so profiling is meant for sizing buffers and stacks
+ *  rather than for production. Heap figures are process wide, so with worker threads they include other requests.
+ */
+
+#ifndef HANDLER_PROFILE_H
+#define HANDLER_PROFILE_H
+
+#include "CommonProgmem.h"
+
+#ifndef HANDLER_PROFILE_STACK_BYTES
+#ifdef LSC_HOST
+#define HANDLER_PROFILE_STACK_BYTES  32768       // Most stack painted below a handler
+#else
+#define HANDLER_PROFILE_STACK_BYTES  3072
+#endif
+#endif
+#define HANDLER_PROFILE_STACK_MARGIN 256         // Stack left unpainted for interrupts, and the least headroom before a warning
+#define HANDLER_PROFILE_PAINT        0xA5
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+struct HandlerProfile {
+  const char*   route          = NULL;
+  unsigned long calls          = 0;
+  size_t        stackPeak      = 0;          // Deepest stack below the dispatch frame, in bytes
+  size_t        stackPainted   = 0;          // Smallest area painted, a handler reaching it is flagged by stackSaturated
+  bool          stackSaturated = false;      // stackPeak is a lower bound, the handler used all of the painted stack
+  long          heapPeak       = 0;          // Most heap in use above entry, sampled at entry, each send and exit
+  long          heapDelta      = 0;          // Largest heap kept by one call after it returned
+  long          heapRetained   = 0;          // Heap kept over all calls, grows steadily with a leak
+};
+
+enum ProfileOrder {PROFILE_STACK, PROFILE_HEAP};
+
+/**
+ *  One profiled handler call, started by the constructor and recorded into the route's profile by end()
+ */
+class ProfileScope {
+  public:
+  ProfileScope(HandlerProfile* profile) __attribute__((noinline));
+
+  void          sampleHeap();
+  void          end();
+
+  private:
+  HandlerProfile* _profile;
+  uintptr_t     _stackTop  = 0;
+  uintptr_t     _stackLow  = 0;
+  size_t        _stackLen  = 0;
+  long          _heapStart = 0;
+  long          _heapPeak  = 0;
+};
+
+/**
+ *  Copy of p taken while no call is being recorded into it
+ */
+extern HandlerProfile profileSnapshot(const HandlerProfile& p);
+
+/**
+ *  Heap in use in bytes, from an arbitrary base so only differences are meaningful
+ */
+extern long heapInUse();
+
+} // End of namespace lsc
+
+#endif
@@ -0,0 +1,227 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "HostPlatform.h"
+
+#ifdef LSC_HOST
+
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <malloc.h>
+#include <atomic>
+
+HostSerial Serial;
+
+static unsigned long long monotonicMicros() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return (unsigned long long)ts.tv_sec*1000000ULL + ts.tv_nsec/1000;
+}
+
+static const unsigned long long _startMicros = monotonicMicros();
+
+unsigned long millis()        {return (unsigned long)((monotonicMicros() - _startMicros)/1000);}
+unsigned long micros()        {return (unsigned long)(monotonicMicros() - _startMicros);}
+void          delay(unsigned long ms) {
+  struct timespec ts = {(time_t)(ms/1000), (long)((ms%1000)*1000000L)};
+  while( nanosleep(&ts,&ts) != 0 && errno == EINTR ) {}
+}
+
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define HOST_SANITIZED_MALLOC
+#endif
+#if defined(__has_feature) && !defined(HOST_SANITIZED_MALLOC)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+#define HOST_SANITIZED_MALLOC
+#endif
+#endif
+
+#ifdef HOST_SANITIZED_MALLOC
+size_t hostHeapInUse()        {return 0;}
+size_t hostAllocCount()       {return 0;}
+size_t hostAllocBytes()       {return 0;}
+#else
+
+/**
+ *   Bytes in use are tracked by usable size, so free() needs no header of its own
+ */
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t,size_t);
+extern "C" void* __libc_realloc(void*,size_t);
+extern "C" void* __libc_memalign(size_t,size_t);
+extern "C" void  __libc_free(void*);
+
+static std::atomic<size_t> _heapInUse{0};
+static std::atomic<size_t> _allocCount{0};
+static std::atomic<size_t> _allocBytes{0};
+
+static void* counted(void* p, size_t size) {
+  if( p != NULL ) {
+    _heapInUse.fetch_add(malloc_usable_size(p),std::memory_order_relaxed);
+    _allocCount.fetch_add(1,std::memory_order_relaxed);
+    _allocBytes.fetch_add(size,std::memory_order_relaxed);
+  }
+  return p;
+}
+
+static void uncounted(void* p) {if( p != NULL ) _heapInUse.fetch_sub(malloc_usable_size(p),std::memory_order_relaxed);}
+
+extern "C" void* malloc(size_t size)                        {return counted(__libc_malloc(size),size);}
+extern "C" void* calloc(size_t n, size_t size)              {return counted(__libc_calloc(n,size),n*size);}
+extern "C" void* memalign(size_t align, size_t size)        {return counted(__libc_memalign(align,size),size);}
+extern "C" void* aligned_alloc(size_t align, size_t size)   {return counted(__libc_memalign(align,size),size);}
+extern "C" void  free(void* p)                              {uncounted(p); __libc_free(p);}
+extern "C" void* realloc(void* p, size_t size) {
+  size_t old    = ((p != NULL)?(malloc_usable_size(p)):(0));
+  void*  result = __libc_realloc(p,size);
+  if( (result != NULL) || (size == 0) ) _heapInUse.fetch_sub(old,std::memory_order_relaxed);
+  return counted(result,size);
+}
+extern "C" int posix_memalign(void** p, size_t align, size_t size) {
+  void* result = __libc_memalign(align,size);
+  if( result == NULL ) return ENOMEM;
+  *p = counted(result,size);
+  return 0;
+}
+
+size_t hostHeapInUse()        {return _heapInUse.load(std::memory_order_relaxed);}
+size_t hostAllocCount()       {return _allocCount.load(std::memory_order_relaxed);}
+size_t hostAllocBytes()       {return _allocBytes.load(std::memory_order_relaxed);}
+#endif
+
+String String::substring(unsigned from, unsigned to) const {
+  if( to > _s.length() ) to = _s.length();
+  if( from >= to ) return String();
+  return String(_s.c_str()+from, to-from);
+}
+
+String IPAddress::toString() const {
+  char buffer[16];
+  snprintf(buffer,sizeof(buffer),"%u.%u.%u.%u",_addr[0],_addr[1],_addr[2],_addr[3]);
+  return String(buffer);
+}
+
+int HostSerial::printf(const char* format, ...) {
+  va_list args;
+  va_start(args,format);
+  int result = vprintf(format,args);
+  va_end(args);
+  return result;
+}
+
+static IPAddress toIPAddress(const struct sockaddr_in& addr) {
+  uint32_t a = ntohl(addr.sin_addr.s_addr);
+  return IPAddress((a>>24)&0xFF,(a>>16)&0xFF,(a>>8)&0xFF,a&0xFF);
+}
+
+WiFiClient::State::~State() {if( fd >= 0 ) ::close(fd);}
+
+WiFiClient::WiFiClient(int fd) {
+  _state = std::make_shared<State>();
+  _state->fd = fd;
+  struct sockaddr_in addr;
+  socklen_t len = sizeof(addr);
+  if( getsockname(fd,(struct sockaddr*)&addr,&len) == 0 ) {_state->localIP = toIPAddress(addr); _state->localPort = ntohs(addr.sin_port);}
+  len = sizeof(addr);
+  if( getpeername(fd,(struct sockaddr*)&addr,&len) == 0 ) {_state->remoteIP = toIPAddress(addr); _state->remotePort = ntohs(addr.sin_port);}
+}
+
+WiFiClient::WiFiClient(String* sink, const IPAddress& local, uint16_t localPort, const IPAddress& remote, uint16_t remotePort) {
+  _state = std::make_shared<State>();
+  _state->sink       = sink;
+  _state->localIP    = local;
+  _state->localPort  = localPort;
+  _state->remoteIP   = remote;
+  _state->remotePort = remotePort;
+}
+
+uint8_t WiFiClient::connected() {
+  if( !_state ) return 0;
+  if( _state->sink != NULL ) return 1;
+  if( _state->fd < 0 ) return 0;
+  char c;
+  ssize_t n = recv(_state->fd,&c,1,MSG_PEEK|MSG_DONTWAIT);
+  return ((n > 0) || ((n < 0) && (errno == EAGAIN || errno == EWOULDBLOCK)));
+}
+
+int WiFiClient::available() {
+  int result = 0;
+  if( _state && (_state->fd >= 0) ) {if( ioctl(_state->fd,FIONREAD,&result) != 0 ) result = 0;}
+  return result;
+}
+
+int WiFiClient::read() {
+  uint8_t c;
+  return ((read(&c,1) == 1)?(c):(-1));
+}
+
+int WiFiClient::read(uint8_t* buf, size_t size) {
+  if( !_state || (_state->fd < 0) ) return -1;
+  ssize_t n = recv(_state->fd,buf,size,0);
+  return ((n>=0)?((int)n):(-1));
+}
+
+size_t WiFiClient::write(const uint8_t* buf, size_t size) {
+  if( !_state ) return 0;
+  if( _state->sink != NULL ) {_state->sink->concat((const char*)buf,size); return size;}
+  size_t sent = 0;
+  while( (_state->fd >= 0) && (sent < size) ) {
+    ssize_t n = ::send(_state->fd,buf+sent,size-sent,MSG_NOSIGNAL);
+    if( n > 0 ) sent += n;
+    else if( (n < 0) && (errno == EINTR) ) continue;
+    else break;
+  }
+  return sent;
+}
+
+/**
+ *   Room in the socket's send buffer. Linux reports SO_SNDBUF doubled for its own bookkeeping, so half is usable.
+ */
+int WiFiClient::availableForWrite() {
+  if( !_state ) return 0;
+  if( _state->sink != NULL ) return 0x7FFFFFFF;
+  int size   = 0;
+  int queued = 0;
+  socklen_t len = sizeof(size);
+  if( (_state->fd < 0) || (getsockopt(_state->fd,SOL_SOCKET,SO_SNDBUF,&size,&len) != 0) || (ioctl(_state->fd,SIOCOUTQ,&queued) != 0) ) return 0;
+  return ((size/2 > queued)?(size/2 - queued):(0));
+}
+
+void WiFiClient::stop() {
+  if( _state ) {
+    if( _state->fd >= 0 ) {::close(_state->fd); _state->fd = -1;}
+    _state->sink = NULL;
+  }
+}
+
+void WiFiClient::setNoDelay(bool nodelay) {
+  int flag = (nodelay?1:0);
+  if( _state && (_state->fd >= 0) ) setsockopt(_state->fd,IPPROTO_TCP,TCP_NODELAY,&flag,sizeof(flag));
+}
+
+#endif
@@ -0,0 +1,221 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Minimal Arduino compatibility layer for building CommonUtil on a Linux host. It provides just enough of
+ *  String, IPAddress, WiFiClient, Serial and the PROGMEM helpers for WebContext, CommonProgmem, and handler
+ *  code written against them, to compile and run natively under perf or valgrind.
+ *  Nothing here is compiled for an Arduino target.
+ */
+
+#ifndef HOST_PLATFORM_H
+#define HOST_PLATFORM_H
+
+#if !defined(ARDUINO) && defined(__linux__)
+#define LSC_HOST
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+#include <memory>
+#include <functional>
+
+/**
+ *   PROGMEM is ordinary memory on the host
+ */
+#define PROGMEM
+#define PGM_P                   const char*
+#define PSTR(s)                 (s)
+#define F(s)                    (s)
+#define FPSTR(p)                (p)
+#define pgm_read_byte(addr)     (*(const unsigned char*)(addr))
+#define memcpy_P                memcpy
+#define strlen_P                strlen
+#define strcmp_P                strcmp
+#define strncmp_P               strncmp
+#define snprintf_P              snprintf
+#define vsnprintf_P             vsnprintf
+
+#if !defined(__GLIBC_PREREQ) || !__GLIBC_PREREQ(2,38)
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+  size_t len = strlen(src);
+  if( size > 0 ) {size_t n = ((len<size)?(len):(size-1)); memcpy(dst,src,n); dst[n] = '\0';}
+  return len;
+}
+#endif
+
+extern unsigned long millis();
+extern unsigned long micros();
+extern void          delay(unsigned long ms);
+inline void          yield() {}
+
+/**
+ *   Heap accounting for profiling and benchmarks. malloc and its relatives are interposed so C and C++ allocations
+ *   are both counted, except in sanitizer builds, which own malloc and where all three report 0.
+ */
+extern size_t        hostHeapInUse();
+extern size_t        hostAllocCount();
+extern size_t        hostAllocBytes();
+
+/**
+ *   Arduino String backed by std::string
+ */
+class String {
+  public:
+  String()                                            {}
+  String(const char* s)                               {if(s != NULL) _s = s;}
+  String(const char* s, size_t len)                   {if(s != NULL) _s.assign(s,len);}
+  String(const String& s)                             : _s(s._s) {}
+  String(String&& s)                                  : _s(std::move(s._s)) {}
+  explicit String(char c)                             : _s(1,c) {}
+  explicit String(int v)                              : _s(std::to_string(v)) {}
+  explicit String(unsigned int v)                     : _s(std::to_string(v)) {}
+  explicit String(long v)                             : _s(std::to_string(v)) {}
+  explicit String(unsigned long v)                    : _s(std::to_string(v)) {}
+
+  String&     operator=(const String& s)              {_s = s._s; return *this;}
+  String&     operator=(String&& s)                   {_s = std::move(s._s); return *this;}
+  String&     operator=(const char* s)                {_s = ((s!=NULL)?(s):("")); return *this;}
+  String&     operator+=(const String& s)             {_s += s._s; return *this;}
+  String&     operator+=(const char* s)               {if(s != NULL) _s += s; return *this;}
+  String&     operator+=(char c)                      {_s += c; return *this;}
+  bool        concat(const char* s, unsigned len)     {if(s != NULL) _s.append(s,len); return true;}
+  bool        reserve(unsigned len)                   {_s.reserve(len); return true;}
+
+  const char* c_str() const                           {return _s.c_str();}
+  unsigned    length() const                          {return _s.length();}
+  bool        isEmpty() const                         {return _s.empty();}
+  char        operator[](unsigned i) const            {return ((i<_s.length())?(_s[i]):('\0'));}
+  bool        equals(const String& s) const           {return _s == s._s;}
+  bool        equals(const char* s) const             {return (s != NULL) && (_s == s);}
+  bool        equalsIgnoreCase(const String& s) const {return (_s.length() == s._s.length()) && (strcasecmp(_s.c_str(),s._s.c_str()) == 0);}
+  bool        operator==(const String& s) const       {return equals(s);}
+  bool        operator==(const char* s) const         {return equals(s);}
+  bool        operator!=(const String& s) const       {return !equals(s);}
+  bool        operator!=(const char* s) const         {return !equals(s);}
+  int         indexOf(char c, unsigned from=0) const  {size_t i = _s.find(c,from); return ((i==std::string::npos)?(-1):((int)i));}
+  String      substring(unsigned from) const          {return substring(from,_s.length());}
+  String      substring(unsigned from, unsigned to) const;
+  long        toInt() const                           {return strtol(_s.c_str(),NULL,10);}
+  void        clear()                                 {_s.clear();}
+
+  private:
+  std::string _s;
+};
+
+inline String operator+(const String& a, const String& b) {String r(a); r += b; return r;}
+inline String operator+(const String& a, const char* b)   {String r(a); r += b; return r;}
+
+/**
+ *   IPv4 Address
+ */
+class IPAddress {
+  public:
+  IPAddress()                                                {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)      {_addr[0]=a; _addr[1]=b; _addr[2]=c; _addr[3]=d;}
+  explicit IPAddress(uint32_t addr)                          {memcpy(_addr,&addr,sizeof(_addr));}
+
+  uint8_t     operator[](int i) const                        {return _addr[i&3];}
+  uint8_t&    operator[](int i)                              {return _addr[i&3];}
+  operator    uint32_t() const                               {uint32_t a; memcpy(&a,_addr,sizeof(a)); return a;}
+  bool        operator==(const IPAddress& a) const           {return memcmp(_addr,a._addr,sizeof(_addr)) == 0;}
+  String      toString() const;
+
+  private:
+  uint8_t     _addr[4] = {0,0,0,0};
+};
+
+/**
+ *   Serial output goes to stdout
+ */
+class HostSerial {
+  public:
+  void     begin(unsigned long)                 {}
+  int      printf(const char* format, ...) __attribute__ ((format (printf, 2, 3)));
+  size_t   print(const char* s)                 {return fputs(s,stdout) >= 0 ? strlen(s) : 0;}
+  size_t   print(const String& s)               {return print(s.c_str());}
+  size_t   println(const char* s="")            {size_t n = print(s); fputc('\n',stdout); return n+1;}
+  size_t   println(const String& s)             {return println(s.c_str());}
+  void     flush()                              {fflush(stdout);}
+  operator bool() const                         {return true;}
+};
+extern HostSerial Serial;
+
+/**
+ *   WiFiClient over either a connected socket or an in-memory sink. Copies share the underlying connection,
+ *   which is closed when the last copy goes away or stop() is called. A memory client appends everything
+ *   written to a caller supplied String and never has data available to read, and is used to replay
+ *   requests in-process.
+ */
+class WiFiClient {
+  public:
+  WiFiClient()                                  {}
+  explicit WiFiClient(int fd);
+  WiFiClient(String* sink, const IPAddress& local, uint16_t localPort, const IPAddress& remote, uint16_t remotePort);
+
+  uint8_t     connected();
+  int         available();
+  int         read();
+  int         read(uint8_t* buf, size_t size);
+  size_t      write(uint8_t c)                  {return write(&c,1);}
+  size_t      write(const uint8_t* buf, size_t size);
+  size_t      write(const char* buf, size_t size) {return write((const uint8_t*)buf,size);}
+  size_t      print(const char* s)              {return write((const uint8_t*)s,strlen(s));}
+  int         availableForWrite();
+  void        flush()                           {}
+  void        stop();
+  void        setNoDelay(bool nodelay);
+  int         fd() const                        {return ((_state)?(_state->fd):(-1));}
+
+  IPAddress   localIP() const                   {return ((_state)?(_state->localIP):(IPAddress()));}
+  uint16_t    localPort() const                 {return ((_state)?(_state->localPort):(0));}
+  IPAddress   remoteIP() const                  {return ((_state)?(_state->remoteIP):(IPAddress()));}
+  uint16_t    remotePort() const                {return ((_state)?(_state->remotePort):(0));}
+  operator    bool()                            {return connected();}
+
+  private:
+  struct State {
+    ~State();
+    int          fd         = -1;
+    String*      sink       = NULL;
+    IPAddress    localIP;
+    IPAddress    remoteIP;
+    uint16_t     localPort  = 0;
+    uint16_t     remotePort = 0;
+  };
+  std::shared_ptr<State> _state;
+};
+
+/**
+ *   Placeholder so WebContext::addHandler() compiles; platform RequestHandlers are not supported on the host.
+ */
+class RequestHandler {
+  public:
+  virtual ~RequestHandler() {}
+};
+
+#endif
+#endif
@@ -0,0 +1,626 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "HostServer.h"
+#include "UrlCodec.h"
+
+#ifdef LSC_HOST
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+const String HostServer::_empty("");
+thread_local HostServer::Request* HostServer::_current = NULL;
+
+HostServer::~HostServer() {
+  stopWorkers();
+  close();
+  while( _routes != NULL ) {Route* r = _routes; _routes = r->next; delete r;}
+}
+
+void HostServer::begin(int port) {
+  close();
+  _listenFd = socket(AF_INET,SOCK_STREAM|SOCK_NONBLOCK|SOCK_CLOEXEC,0);
+  if( _listenFd < 0 ) {Serial.printf("HostServer::begin: socket failed: %s\n",strerror(errno)); return;}
+  int on = 1;
+  setsockopt(_listenFd,SOL_SOCKET,SO_REUSEADDR,&on,sizeof(on));
+  struct sockaddr_in addr;
+  memset(&addr,0,sizeof(addr));
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  addr.sin_port        = htons(port);
+  if( (bind(_listenFd,(struct sockaddr*)&addr,sizeof(addr)) != 0) || (listen(_listenFd,SOMAXCONN) != 0) ) {
+    Serial.printf("HostServer::begin: unable to listen on port %d: %s\n",port,strerror(errno));
+    close();
+    return;
+  }
+  socklen_t len = sizeof(addr);
+  getsockname(_listenFd,(struct sockaddr*)&addr,&len);
+  _port = ntohs(addr.sin_port);
+}
+
+void HostServer::close() {
+  if( _listenFd >= 0 ) {::close(_listenFd); _listenFd = -1;}
+}
+
+void HostServer::on(const char* uri, THandlerFunction f) {
+  Route* r = new Route();
+  r->uri   = uri;
+  r->fn    = f;
+  Route** tail = &_routes;
+  while( *tail != NULL ) tail = &(*tail)->next;
+  *tail = r;
+}
+
+void HostServer::setWorkers(int n) {
+  stopWorkers();
+  _workerCount = ((n < 0)?(0):((n > HOST_MAX_WORKERS)?(HOST_MAX_WORKERS):(n)));
+  for( int i=0; i<_workerCount; i++ ) _workers[i] = std::thread([this](){work();});
+}
+
+/**
+ *  Workers drain the queue, sleeping when it is empty. The queue is checked under _wakeLock before waiting, and
+ *  readConnection() takes the lock before notifying, so a push is never missed.
+ */
+void HostServer::work() {
+  for(;;) {
+    Connection* c = NULL;
+    {
+      std::unique_lock<std::mutex> lock(_wakeLock);
+      while( !_queue.pop(c) ) {
+        if( _stopping ) return;
+        _wake.wait(lock);
+      }
+    }
+    dispatch(c->request);
+    finishDispatch(*c);
+    c->lastActive = millis();
+    c->state.store(CONN_WRITE,std::memory_order_release);
+  }
+}
+
+void HostServer::stopWorkers() {
+  {
+    std::lock_guard<std::mutex> lock(_wakeLock);
+    _stopping = true;
+  }
+  _wake.notify_all();
+  for( int i=0; i<_workerCount; i++ ) _workers[i].join();
+  _workerCount = 0;
+  _stopping    = false;
+}
+
+void HostServer::handleClient() {
+  if( _listenFd < 0 ) return;
+  if( _maxConnections > 0 ) serveEvents();
+  else                      serveOne();
+}
+
+/**
+ *  Accept and serve at most one pending connection. Returns immediately if no client is waiting.
+ */
+void HostServer::serveOne() {
+  int fd = accept4(_listenFd,NULL,NULL,SOCK_CLOEXEC);
+  if( fd < 0 ) return;
+  struct timeval tv = {HOST_READ_TIMEOUT/1000, (HOST_READ_TIMEOUT%1000)*1000};
+  setsockopt(fd,SOL_SOCKET,SO_RCVTIMEO,&tv,sizeof(tv));
+  _main.client = WiFiClient(fd);
+  _main.client.setNoDelay(true);
+  _main.started = micros();
+  _accepted++;
+  if( readRequest() ) {
+    startRequest(_main);
+    _main.keepAlive = false;
+    if( _parser.complete() ) {
+      _served++;
+      dispatch(_main);
+    }
+    else reject(_main);
+  }
+  else abortBody(_main);
+  if( !_main.detached ) _main.client.stop();
+  _main.client = WiFiClient();
+}
+
+/**
+ *  Poll the listening socket and every open connection without blocking, accept while under the connection cap,
+ *  and advance each ready connection by one step. Connections stalled for HOST_READ_TIMEOUT, or kept alive and
+ *  idle for the keep alive timeout, are closed. At the cap, idle kept alive connections give way to new ones.
+ */
+void HostServer::serveEvents() {
+  struct pollfd fds[HOST_MAX_CONNECTIONS+1];
+  Connection*   conns[HOST_MAX_CONNECTIONS+1];
+  int           n      = 0;
+  int           active = activeConnections();
+  if( (active < _maxConnections) || (idleConnection() != NULL) ) {fds[n].fd = _listenFd; fds[n].events = POLLIN; fds[n].revents = 0; conns[n++] = NULL;}
+  for( Connection& c : _connections ) {
+    int state = c.state.load(std::memory_order_acquire);
+    if( (state == CONN_READ) && (c.parser->state() == HTTP_STREAM) ) {processRequest(c); state = c.state.load(std::memory_order_acquire);}
+    if( (state == CONN_FREE) || (state == CONN_DISPATCH) ) continue;
+    fds[n].fd      = c.client.fd();
+    fds[n].events  = ((state == CONN_READ)?(POLLIN):(POLLOUT));
+    fds[n].revents = 0;
+    conns[n++]     = &c;
+  }
+  if( poll(fds,n,0) <= 0 ) {
+    for( int i=0; i<n; i++ ) {if( (conns[i] != NULL) && expired(*conns[i]) ) closeConnection(*conns[i]);}
+    return;
+  }
+  for( int i=0; i<n; i++ ) {
+    Connection* c = conns[i];
+    if( c == NULL ) {
+      while( fds[i].revents & POLLIN ) {
+        if( active >= _maxConnections ) {
+          Connection* idle = idleConnection();
+          if( idle == NULL ) break;
+          closeConnection(*idle);
+          active--;
+        }
+        int fd = accept4(_listenFd,NULL,NULL,SOCK_NONBLOCK|SOCK_CLOEXEC);
+        if( fd < 0 ) break;
+        openConnection(fd);
+        active++;
+      }
+    }
+    else if( fds[i].revents & (POLLERR|POLLNVAL) )                  closeConnection(*c);
+    else if( (c->state == CONN_READ) && (fds[i].revents & (POLLIN|POLLHUP)) ) readConnection(*c);
+    else if( (c->state == CONN_WRITE) && (fds[i].revents & POLLOUT) )   writeConnection(*c);
+    else if( expired(*c) )                                           closeConnection(*c);
+  }
+}
+
+/**
+ *  True if c has waited too long, for the rest of a request or, when kept alive, for the next one
+ */
+bool HostServer::expired(const Connection& c) const {
+  bool idle = (c.served > 0) && (buffered(c) == 0) && (c.state.load(std::memory_order_relaxed) == CONN_READ);
+  return (millis() - c.lastActive) > ((idle)?(_keepAliveTimeout):((unsigned long)HOST_READ_TIMEOUT));
+}
+
+/**
+ *  The kept alive connection idle the longest, or NULL if none is waiting between requests
+ */
+HostServer::Connection* HostServer::idleConnection() {
+  Connection* result = NULL;
+  for( Connection& c : _connections ) {
+    if( (c.served > 0) && (buffered(c) == 0) && (c.state.load(std::memory_order_relaxed) == CONN_READ) ) {
+      if( (result == NULL) || ((long)(c.lastActive - result->lastActive) < 0) ) result = &c;
+    }
+  }
+  return result;
+}
+
+int HostServer::activeConnections() const {
+  int result = 0;
+  for( const Connection& c : _connections ) {if( c.state.load(std::memory_order_relaxed) != CONN_FREE ) result++;}
+  return result;
+}
+
+void HostServer::openConnection(int fd) {
+  for( Connection& c : _connections ) {
+    if( c.state == CONN_FREE ) {
+      if( c.parser == NULL ) {c.parser = new HttpParser(); c.parser->setStreamFunction(streamFunction());}
+      c.parser->reset();
+      c.request.parser = c.parser;
+      c.client     = WiFiClient(fd);
+      c.request.connection = c.client;
+      c.client.setNoDelay(true);
+      c.state      = CONN_READ;
+      c.sent       = 0;
+      c.served     = 0;
+      c.started    = micros();
+      c.lastActive = millis();
+      c.response.clear();
+      _accepted++;
+      return;
+    }
+  }
+  ::close(fd);
+}
+
+/**
+ *  One read straight into the parser's buffer, processing the request once it is complete or rejected. A full
+ *  buffer is left to the parser to reject, or when streaming waits for the body handler to take some.
+ */
+void HostServer::readConnection(Connection& c) {
+  size_t avail;
+  char*  space = c.parser->space(avail);
+  if( holding(*c.parser) ) return;
+  if( avail > HOST_IO_QUANTUM ) avail = HOST_IO_QUANTUM;
+  int n = ((avail > 0)?(c.client.read((uint8_t*)space,avail)):(-1));
+  if( n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) ) return;
+  if( n <= 0 ) {closeConnection(c); return;}
+  if( (buffered(c) == 0) && (c.served > 0) ) c.started = micros();
+  c.parser->received(n);
+  c.lastActive = millis();
+  processRequest(c);
+}
+
+/**
+ *  Once the parser has a complete request, capture its response for writeConnection() and either queue it to a
+ *  worker or dispatch it here. Bytes past the request, pipelined by the client, stay in the parser. A rejected
+ *  request is answered with the parser's error status and the connection closed after it. A streamed body is
+ *  passed to the body handler here first, as it arrives.
+ */
+void HostServer::processRequest(Connection& c) {
+  HttpParseState state = c.parser->state();
+  if( (state != HTTP_STREAM) && (state != HTTP_COMPLETE) && (state != HTTP_ERROR) ) return;
+  if( !c.request.streaming ) {
+    c.request.client = WiFiClient(&c.response,c.client.localIP(),c.client.localPort(),c.client.remoteIP(),c.client.remotePort());
+    c.sent = 0;
+  }
+  if( state == HTTP_STREAM ) {
+    if( streamBody(c.request) ) c.lastActive = millis();
+    if( (state = c.parser->state()) == HTTP_STREAM ) return;
+  }
+  startRequest(c.request);
+  if( state == HTTP_ERROR ) {
+    reject(c.request);
+    c.state = CONN_WRITE;
+    return;
+  }
+  c.request.started   = c.started;
+  c.request.keepAlive = c.request.keepAlive && (_keepAliveTimeout > 0) && (c.served+1 < _keepAliveMax);
+  _served++;
+  if( c.served > 0 ) _reused++;
+  if( (_workerCount > 0) && !((_affinity != NULL) && _affinity(c.parser->path())) && _queue.push(&c) ) {
+    c.state.store(CONN_DISPATCH,std::memory_order_relaxed);
+    {std::lock_guard<std::mutex> lock(_wakeLock);}
+    _wake.notify_one();
+  }
+  else {
+    dispatch(c.request);
+    finishDispatch(c);
+    c.state = CONN_WRITE;
+  }
+}
+
+/**
+ *  A connection is only kept alive if its response is complete and delimited, by Content-Length or a final chunk
+ */
+void HostServer::finishDispatch(Connection& c) {
+  if( (c.request.status == 0) || c.request.chunked ) c.request.keepAlive = false;
+}
+
+/**
+ *  Ready a kept alive connection for its next request, processing one already pipelined in the buffer
+ */
+void HostServer::nextRequest(Connection& c) {
+  c.parser->next();
+  c.sent   = 0;
+  c.served++;
+  c.response.clear();
+  c.request.client = WiFiClient();
+  c.lastActive = millis();
+  c.started    = micros();
+  c.state  = CONN_READ;
+  processRequest(c);
+}
+
+void HostServer::writeConnection(Connection& c) {
+  if( c.request.detached ) {releaseConnection(c); return;}
+  size_t want = c.response.length() - c.sent;
+  if( want == 0 ) {closeConnection(c); return;}
+  if( want > HOST_IO_QUANTUM ) want = HOST_IO_QUANTUM;
+  ssize_t n = ::send(c.client.fd(),c.response.c_str()+c.sent,want,MSG_NOSIGNAL|MSG_DONTWAIT);
+  if( n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ) return;
+  if( n <= 0 ) {closeConnection(c); return;}
+  c.sent      += n;
+  c.lastActive = millis();
+  if( c.sent == c.response.length() ) {
+    if( c.request.keepAlive ) nextRequest(c);
+    else                      closeConnection(c);
+  }
+}
+
+void HostServer::closeConnection(Connection& c) {
+  abortBody(c.request);
+  c.client.stop();
+  c.client = WiFiClient();
+  c.request.client = WiFiClient();
+  c.request.connection = WiFiClient();
+  c.state  = CONN_FREE;
+  c.request.streaming = false;
+  c.request.detached  = false;
+  if( c.parser != NULL ) c.parser->reset();
+  c.served = 0;
+  c.response.clear();
+}
+
+/**
+ *  Forget a connection its handler detached, leaving the socket open for the client holding it
+ */
+void HostServer::releaseConnection(Connection& c) {
+  c.client = WiFiClient();
+  closeConnection(c);
+}
+
+WiFiClient HostServer::detach() {
+  Request&   r      = request();
+  WiFiClient client = ((r.connection.fd() >= 0)?(r.connection):(r.client));
+  if( client.fd() < 0 ) return WiFiClient();
+  r.detached = true;
+  return client;
+}
+
+int HostServer::inject(const char* request, String& response) {
+  _parser.reset();
+  _main.streaming = false;
+  _main.client    = WiFiClient(&response,IPAddress(127,0,0,1),_port,IPAddress(127,0,0,1),0);
+  _main.started   = micros();
+  size_t len = strlen(request);
+  for(;;) {
+    size_t avail;
+    char*  space = _parser.space(avail);
+    size_t n     = ((len < avail)?(len):(avail));
+    memcpy(space,request,n);
+    _parser.received(n);
+    request += n;
+    len     -= n;
+    bool progress = (n > 0);
+    if( _parser.state() == HTTP_STREAM )               progress = streamBody(_main) || progress;
+    else if( _parser.complete() || _parser.failed() ) break;
+    if( !progress ) break;
+  }
+  abortBody(_main);
+  startRequest(_main);
+  _main.keepAlive = false;
+  if( _parser.complete() )                  dispatch(_main);
+  else if( _parser.state() == HTTP_ERROR )  reject(_main);
+  int result = _main.status;
+  _main.client.stop();
+  _main.client = WiFiClient();
+  return result;
+}
+
+/**
+ *  Read a request from _main.client into _parser until it is complete or rejected, streaming its body if it has
+ *  one to stream. Returns false if the client closes or stalls first, or the body handler stops taking the body
+ *  for HOST_READ_TIMEOUT.
+ */
+bool HostServer::readRequest() {
+  _parser.reset();
+  _main.streaming = false;
+  unsigned long progress = millis();
+  while( (_parser.state() != HTTP_COMPLETE) && (_parser.state() != HTTP_ERROR) ) {
+    size_t avail;
+    char*  space = _parser.space(avail);
+    if( _parser.state() == HTTP_STREAM ) {
+      if( streamBody(_main) ) {progress = millis(); continue;}
+      if( holding(_parser) ) {
+        if( millis() - progress > HOST_READ_TIMEOUT ) return false;
+        delay(1);
+        continue;
+      }
+    }
+    int    n     = _main.client.read((uint8_t*)space,avail);
+    if( n <= 0 ) return false;
+    _parser.received(n);
+  }
+  return true;
+}
+
+/**
+ *  Pass the streamed body buffered in r.parser to the body handler, with r the current request, until none is left
+ *  or the handler takes none. The request is started on the first call. Returns true if the handler took any.
+ */
+bool HostServer::streamBody(Request& r) {
+  if( !r.streaming ) {startRequest(r); r.streaming = true;}
+  Request* previous = _current;
+  _current = &r;
+  bool        result = false;
+  size_t      len;
+  const char* data;
+  while( (r.parser->state() == HTTP_STREAM) && ((data = r.parser->bodyData(len)) != NULL) ) {
+    size_t n = ((_body != NULL)?(_body(data,len,r.parser->contentLength() - r.parser->bodyRemaining())):(len));
+    if( n == 0 ) break;
+    r.parser->consume(n);
+    result = true;
+  }
+  _current = previous;
+  return result;
+}
+
+/**
+ *  Tell the body handler that the body r is streaming ends early, its connection closed or the request cut short,
+ *  with data NULL at the offset reached. The request is left unstarted, so it is not dispatched.
+ */
+void HostServer::abortBody(Request& r) {
+  if( !r.streaming || (r.parser->state() != HTTP_STREAM) ) return;
+  r.streaming = false;
+  Request* previous = _current;
+  _current = &r;
+  if( _body != NULL ) _body(NULL,0,r.parser->contentLength() - r.parser->bodyRemaining());
+  _current = previous;
+}
+
+/**
+ *  True if p is streaming a body the body handler has yet to take, with nothing more to read until it does: the
+ *  buffer is full, or holds the rest of the body
+ */
+bool HostServer::holding(HttpParser& p) {
+  size_t avail;
+  size_t len;
+  p.space(avail);
+  return (p.state() == HTTP_STREAM) && ((avail == 0) || ((p.bodyData(len) != NULL) && (len == p.bodyRemaining())));
+}
+
+/**
+ *  Reset response state and the Strings copied from the parser for a new request in r.parser. A request with a
+ *  streamed body was started when streaming began, and is left as it is.
+ */
+void HostServer::startRequest(Request& r) {
+  if( r.streaming ) {r.streaming = false; return;}
+  r.status        = 0;
+  r.detached      = false;
+  r.chunked       = false;
+  r.contentLength = CONTENT_LENGTH_NOT_SET;
+  r.uriCopied     = false;
+  r.argsCopied    = 0;
+  r.headersCopied = 0;
+  r.keepAlive     = r.parser->keepAlive();
+  r.responseHeaders.clear();
+}
+
+/**
+ *  Answer a request the parser rejected with its error status, closing the connection after
+ */
+void HostServer::reject(Request& r) {
+  Request* previous = _current;
+  _current    = &r;
+  r.keepAlive = false;
+  send(r.parser->error(),"text/plain",statusText(r.parser->error()));
+  _current    = previous;
+}
+
+/**
+ *  Call the handler for r, on the calling thread, with r as the current request of that thread
+ */
+void HostServer::dispatch(Request& r) {
+  Request* previous = _current;
+  _current = &r;
+  Route* route = _routes;
+  while( (route != NULL) && (strcmp(route->uri.c_str(),r.parser->path()) != 0) ) route = route->next;
+  if( route != NULL )          route->fn();
+  else if( _notFound != NULL ) _notFound();
+  else                         send(404,"text/plain","Not Found");
+  _current = previous;
+}
+
+void HostServer::collectHeaders(const char* names[], size_t count) {
+  _headerCount = ((count<HOST_MAX_HEADERS)?(count):(HOST_MAX_HEADERS));
+  for( size_t i=0; i<_headerCount; i++ ) _headerKeys[i] = names[i];
+}
+
+/**
+ *  Strings are copied from the parser on first use in a request, so that requests whose handlers read arguments
+ *  through parser() or not at all copy nothing
+ */
+const String& HostServer::header(const char* name) {
+  Request& r = request();
+  for( size_t i=0; i<_headerCount; i++ ) {
+    if( strcasecmp(_headerKeys[i],name) == 0 ) {
+      if( (r.headersCopied & (1UL << i)) == 0 ) {r.headerValues[i] = r.parser->header(name); r.headersCopied |= (1UL << i);}
+      return r.headerValues[i];
+    }
+  }
+  return _empty;
+}
+
+const String& HostServer::arg(int i) {
+  Request& r = request();
+  if( (i < 0) || (i >= r.parser->argCount()) ) return _empty;
+  if( (r.argsCopied & (1UL << i)) == 0 ) {r.argNames[i] = r.parser->argName(i); r.argValues[i] = r.parser->arg(i); r.argsCopied |= (1UL << i);}
+  return r.argValues[i];
+}
+
+const String& HostServer::argName(int i) {
+  arg(i);
+  return (((i >= 0) && (i < request().parser->argCount()))?(request().argNames[i]):(_empty));
+}
+
+const String& HostServer::uri() {
+  Request& r = request();
+  if( !r.uriCopied ) {r.uri = r.parser->path(); r.uriCopied = true;}
+  return r.uri;
+}
+
+void HostServer::sendHeader(const char* name, const char* value) {
+  Request& r = request();
+  r.responseHeaders += name;
+  r.responseHeaders += ": ";
+  r.responseHeaders += value;
+  r.responseHeaders += "\r\n";
+}
+
+/**
+ *  Send response headers and content. If setContentLength(CONTENT_LENGTH_UNKNOWN) was called beforehand the
+ *  response uses chunked transfer encoding; content, if any, is sent as the first chunk and the remainder
+ *  follows with sendContent(), ending with a zero length sendContent().
+ */
+void HostServer::send(int code, const char* contentType, const char* content) {
+  Request& r = request();
+  char header[256];
+  size_t len = ((content != NULL)?(strlen(content)):(0));
+  r.chunked = (r.contentLength == CONTENT_LENGTH_UNKNOWN);
+  int n = snprintf(header,sizeof(header),"HTTP/1.1 %d %s\r\nContent-Type: %s\r\n",code,statusText(code),((contentType != NULL)?(contentType):("text/plain")));
+  if( r.chunked ) n += snprintf(header+n,sizeof(header)-n,"Transfer-Encoding: chunked\r\n");
+  else            n += snprintf(header+n,sizeof(header)-n,"Content-Length: %zu\r\n",((r.contentLength == CONTENT_LENGTH_NOT_SET)?(len):(r.contentLength)));
+  r.client.write(header,((n<(int)sizeof(header))?(n):(sizeof(header)-1)));
+  r.client.write(r.responseHeaders.c_str(),r.responseHeaders.length());
+  if( r.keepAlive ) r.client.write("Connection: keep-alive\r\n\r\n",26);
+  else              r.client.write("Connection: close\r\n\r\n",21);
+  r.responseHeaders.clear();
+  r.contentLength = CONTENT_LENGTH_NOT_SET;
+  r.status = code;
+  if( len > 0 ) sendContent(content,len);
+}
+
+void HostServer::sendContent(const char* content, size_t len) {
+  Request& r = request();
+  if( r.chunked ) {
+    char size[16];
+    int n = snprintf(size,sizeof(size),"%zx\r\n",len);
+    r.client.write(size,n);
+    if( len > 0 ) r.client.write(content,len);
+    r.client.write("\r\n",2);
+    if( len == 0 ) r.chunked = false;
+  }
+  else if( len > 0 ) r.client.write(content,len);
+}
+
+const char* HostServer::statusText(int code) {
+  switch(code) {
+    case 200: return "OK";
+    case 204: return "No Content";
+    case 301: return "Moved Permanently";
+    case 302: return "Found";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 414: return "URI Too Long";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    case 501: return "Not Implemented";
+    case 503: return "Service Unavailable";
+    case 505: return "HTTP Version Not Supported";
+    default:  return "";
+  }
+}
+
+} // End of namespace lsc
+
+#endif
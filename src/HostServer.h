@@ -0,0 +1,277 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Minimal HTTP/1.1 server for the Linux host, shaped after the subset of ESP8266WebServer used by WebContext.
+ *  Requests arrive either on a POSIX listening socket, serviced from handleClient(), or are injected in-process 
+ *  with inject(), which runs the same parse and dispatch path and captures the response in a String. Injection 
+ *  has no socket overhead, so handler code can be driven at high request rates under perf or valgrind.
+ *
+ *  By default handleClient() serves one connection at a time, reading the request and writing the response
+ *  before it returns, as ESP8266WebServer does. After setMaxConnections(n) it is event driven instead: up to n
+ *  connections are tracked at once and each call polls them and advances every ready connection one step,
+ *
+ *     READ      one read of at most HOST_IO_QUANTUM bytes, dispatching once the request is complete
+ *     WRITE     one write of at most HOST_IO_QUANTUM bytes of the buffered response, closing when done
+ *
+ *  so a slow client holds only its own connection rather than the server. After setKeepAlive() as well, HTTP/1.1
+ *  connections stay open between requests, so a page and its stylesheet and frames share one connection. Requests
+ *  pipelined on a connection are answered in order, each read from the bytes left in the buffer once the response
+ *  to the one before it is written. The handler still runs to completion
+ *  when dispatched, with its response buffered for the connection. With setWorkers(n) as well, complete requests
+ *  are queued to n worker threads over a lock-free WorkQueue and dispatched there, so pages render on every
+ *  core while handleClient() keeps reading and writing. Each connection holds its own Request, so arg(), uri(),
+ *  header() and send() called from a handler refer to the request that thread is dispatching.
+ *
+ *  Requests are parsed by an HttpParser (see HttpParser.h) reading straight from the socket into its buffer, one
+ *  per connection, with no allocation. The String returned by arg(), argName() and header() is copied from the
+ *  parser on first use in each request, and parser() gives handlers the request without copies.
+ *
+ *  Bodies of requests chosen by setBodyHandler() are streamed rather than collected, so they may be of any size.
+ *  The body handler is called on the handleClient() thread as each read arrives, with the request current, and
+ *  the handler of the route is dispatched as usual once the last byte is taken. A body handler taking nothing
+ *  holds the body back: its connection stops reading until the handler is called again and takes some.
+ */
+
+#ifndef HOST_SERVER_H
+#define HOST_SERVER_H
+
+#include "HostPlatform.h"
+
+#ifdef LSC_HOST
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "WorkQueue.h"
+#include "HttpParser.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+#define HOST_MAX_HEADERS     16                  // Headers retained by collectHeaders(), all are parsed
+#define HOST_READ_TIMEOUT    2000
+#define HOST_MAX_CONNECTIONS 32                  // Upper bound for setMaxConnections(), a power of 2
+#define HOST_MAX_WORKERS     8                   // Upper bound for setWorkers()
+#define HOST_IO_QUANTUM      4096                // Bytes read or written per connection per handleClient() when event driven
+#define HOST_KEEP_ALIVE_MAX  100                 // Default requests served on one persistent connection
+
+#ifndef CONTENT_LENGTH_UNKNOWN
+#define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
+#endif
+#ifndef CONTENT_LENGTH_NOT_SET
+#define CONTENT_LENGTH_NOT_SET ((size_t) -2)
+#endif
+
+class HostServer {
+
+  public:
+  typedef std::function<void(void)> THandlerFunction;
+  typedef std::function<bool(const char* uri)> AffinityFunction;
+  typedef std::function<size_t(const char* data, size_t len, size_t offset)> TBodyFunction;
+
+  HostServer()                                           {_main.parser = &_parser; _parser.setStreamFunction(streamFunction());}
+  ~HostServer();
+
+  void            begin(int port);
+  void            close();
+  void            handleClient();
+  void            setMaxConnections(int n)               {_maxConnections = ((n < 0)?(0):((n > HOST_MAX_CONNECTIONS)?(HOST_MAX_CONNECTIONS):(n)));}
+  int             maxConnections() const                 {return _maxConnections;}
+  int             activeConnections() const;
+
+/**
+ *   Dispatch requests to a pool of n worker threads, 0 to dispatch on the thread calling handleClient(). Workers
+ *   are used in event driven mode only. A request for which the affinity function returns true is dispatched on
+ *   the handleClient() thread.
+ */
+  void            setWorkers(int n);
+  int             workers() const                        {return _workerCount;}
+  void            setAffinityFunction(AffinityFunction f) {_affinity = f;}
+
+/**
+ *   Stream the body of each request for which stream returns true to body, len bytes at a time from offset in the
+ *   body. body returns the bytes it took, 0 to be called again with the same bytes later. If the connection closes
+ *   or the request ends before the body does, body is called once more with data NULL and the route is not run.
+ */
+  void            setBodyHandler(AffinityFunction stream, TBodyFunction body) {_stream = stream; _body = body;}
+
+/**
+ *   Keep connections open for up to maxRequests requests, closing those idle for timeout ms, 0 to close after each
+ *   response. Used in event driven mode only. When every connection is taken, the longest idle one is closed to
+ *   accept a new one.
+ */
+  void            setKeepAlive(unsigned long timeout, int maxRequests=HOST_KEEP_ALIVE_MAX) {_keepAliveTimeout = timeout; _keepAliveMax = ((maxRequests < 1)?(1):(maxRequests));}
+  unsigned long   keepAliveTimeout() const               {return _keepAliveTimeout;}
+
+/**
+ *   Counters since begin(): connections accepted, requests served, and requests served on a connection that had
+ *   already served one
+ */
+  unsigned long   acceptedConnections() const            {return _accepted;}
+  unsigned long   servedRequests() const                 {return _served;}
+  unsigned long   reusedRequests() const                 {return _reused;}
+
+  void            on(const char* uri, THandlerFunction f);
+  void            onNotFound(THandlerFunction f)         {_notFound = f;}
+  void            send(int code, const char* contentType, const char* content);
+  void            send_P(int code, PGM_P contentType, PGM_P content) {send(code,contentType,content);}
+  void            send_P(int code, PGM_P contentType, PGM_P content, size_t len) {setContentLength(len); send(code,contentType,""); sendContent(content,len);}
+  void            setContentLength(size_t len)           {request().contentLength = len;}
+  void            sendContent(const char* content, size_t len);
+  void            sendHeader(const char* name, const char* value);
+  void            collectHeaders(const char* names[], size_t count);
+  const String&   header(const char* name);
+  int             args()                                 {return request().parser->argCount();}
+  const String&   arg(int i);
+  const String&   argName(int i);
+  const String&   uri();
+  const HttpParser* parser()                             {return request().parser;}
+  WiFiClient      client()                               {return request().client;}
+
+/**
+ *   Take the connection of the current request from the server, which sends nothing more on it and forgets it once
+ *   the handler returns, so that the returned client can keep it open, for a stream of events for example. Anything
+ *   sent through the server for the request is discarded. An injected request has no connection to take, and
+ *   returns an unconnected client with the request left to the server, since its memory client writes to a String
+ *   the caller of inject() owns.
+ */
+  WiFiClient      detach();
+  unsigned long   requestStart()                         {return request().started;}
+  int             port()                                 {return _port;}
+
+/**
+ *   Replay a raw HTTP request, for example "GET /device?a=1 HTTP/1.1\r\n\r\n", through the registered handlers
+ *   without a socket. The full response is appended to response, and the status code is returned (0 if the
+ *   handler sent nothing). Nothing is written to response once inject() returns.
+ */
+  int             inject(const char* request, String& response);
+
+  static const char*  statusText(int code);
+
+  private:
+  struct Route {
+    String            uri;
+    THandlerFunction  fn;
+    Route*            next = NULL;
+  };
+
+/**
+ *  State of one request, from parse to response. Requests on connections each have their own, so requests
+ *  dispatched on different threads share nothing.
+ */
+  struct Request {
+    HttpParser*       parser    = NULL;        // The connection's, or _parser for _main
+    String            uri;
+    String            argNames[HTTP_MAX_ARGS];
+    String            argValues[HTTP_MAX_ARGS];
+    String            headerValues[HOST_MAX_HEADERS];
+    bool              uriCopied = false;       // uri, arg i and header i copied from the parser this request
+    uint32_t          argsCopied = 0;
+    uint32_t          headersCopied = 0;
+    String            responseHeaders;
+    WiFiClient        client;
+    int               status    = 0;
+    size_t            contentLength = CONTENT_LENGTH_NOT_SET;
+    bool              chunked   = false;
+    bool              keepAlive = false;       // Response leaves the connection open
+    bool              streaming = false;       // Started, with its body streaming
+    bool              detached  = false;       // Connection taken by the handler with detach()
+    WiFiClient        connection;              // The socket, where client captures the response for it
+    unsigned long     started   = 0;           // micros() when the connection was accepted or, kept alive, the request began
+  };
+
+  enum ConnectionState {CONN_FREE, CONN_READ, CONN_DISPATCH, CONN_WRITE};
+
+  struct Connection {
+    ~Connection()                                        {delete parser;}
+    std::atomic<int>  state{CONN_FREE};            // Written by a worker when dispatch completes
+    WiFiClient        client;
+    HttpParser*       parser    = NULL;        // Allocated on first use and kept
+    Request           request;
+    String            response;
+    size_t            sent      = 0;
+    int               served    = 0;           // Requests answered on this connection
+    unsigned long     started   = 0;           // micros() when the request in the buffer began
+    unsigned long     lastActive = 0;
+  };
+
+  Request&        request()                              {return ((_current != NULL)?(*_current):(_main));}
+  void            serveOne();
+  void            serveEvents();
+  void            openConnection(int fd);
+  void            readConnection(Connection& c);
+  void            processRequest(Connection& c);
+  void            nextRequest(Connection& c);
+  void            writeConnection(Connection& c);
+  void            closeConnection(Connection& c);
+  void            releaseConnection(Connection& c);
+  bool            expired(const Connection& c) const;
+  Connection*     idleConnection();
+  static void     finishDispatch(Connection& c);
+  static size_t   buffered(const Connection& c)          {return ((c.parser != NULL)?(c.parser->buffered()):(0));}
+  void            work();
+  void            stopWorkers();
+  bool            readRequest();
+  bool            streamBody(Request& r);
+  void            abortBody(Request& r);
+  static bool     holding(HttpParser& p);
+  StreamFunction  streamFunction()                       {return [this](const HttpParser& p)->bool {return (_stream != NULL) && _stream(p.path());};}
+  void            startRequest(Request& r);
+  void            reject(Request& r);
+  void            dispatch(Request& r);
+
+  Route*              _routes     = NULL;
+  THandlerFunction    _notFound   = NULL;
+  AffinityFunction    _affinity   = NULL;
+  AffinityFunction    _stream     = NULL;
+  TBodyFunction       _body       = NULL;
+  Request             _main;                   // Request served by serveOne() and inject()
+  HttpParser          _parser;                 // Parser of _main
+  const char*         _headerKeys[HOST_MAX_HEADERS];
+  size_t              _headerCount = 0;
+  int                 _listenFd   = -1;
+  int                 _port       = 0;
+  int                 _maxConnections = 0;
+  unsigned long       _keepAliveTimeout = 0;
+  int                 _keepAliveMax = HOST_KEEP_ALIVE_MAX;
+  unsigned long       _accepted   = 0;
+  unsigned long       _served     = 0;
+  unsigned long       _reused     = 0;
+  Connection          _connections[HOST_MAX_CONNECTIONS];
+  WorkQueue<Connection*,HOST_MAX_CONNECTIONS> _queue;
+  std::thread         _workers[HOST_MAX_WORKERS];
+  int                 _workerCount = 0;
+  std::mutex          _wakeLock;
+  std::condition_variable _wake;
+  bool                _stopping   = false;
+  static thread_local Request* _current;       // Request being dispatched on this thread, NULL for _main
+  static const String _empty;
+
+  static_assert(HTTP_MAX_ARGS <= 32,"Request::argsCopied has a bit per argument");
+};
+
+} // End of namespace lsc
+
+#endif
+#endif
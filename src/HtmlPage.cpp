@@ -0,0 +1,67 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "HtmlPage.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+size_t HtmlPage::send(int statusCode, PageFunction body, PGM_P contentType) {
+  _length    = 0;
+  _sent      = 0;
+  _measuring = true;
+  _truncated = false;
+  body(*this);
+  _measuring = false;
+  _writer.begin(statusCode,contentType,_length);
+  body(*this);
+  if( _sent < _length ) {
+    static const char spaces[] = "                ";
+    _truncated = true;
+    while( _sent < _length ) write(spaces,sizeof(spaces)-1);
+  }
+  _writer.end();
+  return _length;
+}
+
+/**
+ *   The measuring pass only counts, so any page can be measured on a page that is never sent
+ */
+size_t HtmlPage::length(PageFunction body) {
+  HtmlPage page(NULL);
+  body(page);
+  return page._length;
+}
+
+/**
+ *   Bytes of len that still fit in the measured length
+ */
+size_t HtmlPage::room(size_t len) {
+  size_t n = ((_sent + len <= _length)?(len):(_length - _sent));
+  if( n < len ) _truncated = true;
+  _sent += n;
+  return n;
+}
+
+} // End of namespace lsc
@@ -0,0 +1,107 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** HtmlPage composes a page from the HtmlTemplate components and sends it with an exact Content-Length, with no
+ *  page buffer and no chunked encoding. The page is described by a body function that adds components, and send()
+ *  runs it twice: first to add up component lengths, which formats nothing, then to stream the components through
+ *  a ResponseWriter chunk buffer. For example:
+ *
+ *    HtmlPage page(c);
+ *    page.send(200,[&](HtmlPage& p) {
+ *      p.header().title("Nearby Devices");
+ *      for( int i=0; i<count; i++ ) p.appButton(urls[i],names[i]);
+ *      p.tail();
+ *    });
+ *
+ *  The body must add the same components with the same arguments on both passes. Should the second pass differ,
+ *  the body is cut or padded with spaces to the length already sent, and truncated() is set. Components other
+ *  than those below are added with add(), given any HtmlTemplate and its arguments.
+ */
+
+#ifndef HTML_PAGE_H
+#define HTML_PAGE_H
+
+#include "HtmlTemplate.h"
+#include "ResponseWriter.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+class HtmlPage;
+typedef std::function<void(HtmlPage& page)> PageFunction;
+
+class HtmlPage {
+  public:
+  HtmlPage(WebContext* ctx) : _writer(ctx) {}
+
+/**
+ *   Measure and send the page built by body, returning its length
+ */
+  size_t      send(int statusCode, PageFunction body, PGM_P contentType=TEXT_HTML);
+
+/**
+ *   Exact length of the page built by body, without sending anything
+ */
+  static size_t length(PageFunction body);
+
+  template<typename... Args, typename... Values>
+  HtmlPage&   add(const HtmlTemplate<Args...>& t, Values... values)     {if( _measuring ) _length += t.length(values...); else t.render(*this,values...); return *this;}
+  HtmlPage&   text(const char* s)                                        {if( s != NULL ) write(s,strlen(s)); return *this;}
+  HtmlPage&   text_P(PGM_P s)                                            {if( s != NULL ) write_P(s,strlen_P(s)); return *this;}
+
+  HtmlPage&   header()                                                   {return add(html_header_tmpl);}
+  HtmlPage&   title(const char* text)                                    {return add(html_title_tmpl,text);}
+  HtmlPage&   subtitle(const char* text)                                 {return add(html_L2_title_tmpl,text);}
+  HtmlPage&   heading(const char* text)                                  {return add(html_L3_title_tmpl,text);}
+  HtmlPage&   appButton(const char* href, const char* label)             {return add(app_button_tmpl,href,label);}
+  HtmlPage&   smallButton(const char* href, const char* label)           {return add(small_button_tmpl,href,label);}
+  HtmlPage&   configButton(const char* href, const char* label)          {return add(config_button_tmpl,href,label);}
+  HtmlPage&   nearbyButton(const char* device)                           {return add(nearby_html_tmpl,device);}
+  HtmlPage&   iframe(const char* src, int height, int width)             {return add(iframe_html_tmpl,src,height,width);}
+  HtmlPage&   tail()                                                     {return add(html_tail_tmpl);}
+
+/**
+ *   Sink interface for HtmlTemplate::render(), counting or writing within the measured length
+ */
+  void        write(const char* content, size_t len)                     {if( _measuring ) _length += len; else _writer.write(content,room(len));}
+  void        write_P(PGM_P content, size_t len)                         {if( _measuring ) _length += len; else _writer.write_P(content,room(len));}
+
+  size_t      measured() const                                           {return _length;}
+  bool        truncated() const                                          {return _truncated;}
+
+  private:
+  HtmlPage(const HtmlPage&) = delete;
+  HtmlPage& operator=(const HtmlPage&) = delete;
+  size_t      room(size_t len);
+
+  ResponseWriter _writer;
+  size_t      _length    = 0;
+  size_t      _sent      = 0;
+  bool        _measuring = true;
+  bool        _truncated = false;
+};
+
+} // End of namespace lsc
+
+#endif
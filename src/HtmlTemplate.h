@@ -0,0 +1,197 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** HtmlTemplate is a compile time parsed alternative to running the PROGMEM printf templates through vsnprintf_P.
+ *  The template is split into literal segments and typed slots when the compiler evaluates the constexpr
+ *  constructor, and the declared argument types are checked against the slots, so a mismatch is a compile error
+ *  rather than garbage on the page. At render time literal segments are bulk copied with memcpy_P and slots are
+ *  written directly, with no format parsing. The exact rendered length is available before anything is written.
+ *
+ *  Slots are %s (const char*), %d (int) and %u (unsigned int) with no flags, width or precision; anything else,
+ *  including %%, is rejected. Templates must be constexpr char arrays, as are those in CommonProgmem.h. For example:
+ *
+ *    constexpr char row[] PROGMEM = "<tr><td>%s</td><td>%d</td></tr>";
+ *    constexpr HtmlTemplate<const char*,int> row_tmpl(row);
+ *
+ *    BufferBuilder b(buffer,sizeof(buffer));
+ *    html_header_tmpl.render(b);
+ *    row_tmpl.render(b,"Relay",1);
+ *    size_t len = row_tmpl.length("Relay",2);
+ *
+ *  render() accepts anything with write(const char*,size_t) and write_P(PGM_P,size_t), including BufferBuilder and
+ *  ResponseWriter. Declare template objects constexpr so that a format error is reported at compile time.
+ */
+
+#ifndef HTML_TEMPLATE_H
+#define HTML_TEMPLATE_H
+
+#include "CommonProgmem.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+/**
+ *   Never defined: a template whose format does not match its declared arguments fails to compile when the
+ *   template object is constexpr, and fails to link otherwise.
+ */
+extern size_t html_template_format_does_not_match_arguments();
+
+/**
+ *   Compile time scanning of a template format
+ */
+struct TemplateFormat {
+  static constexpr bool   isSlot(char c)                                 {return (c == 's') || (c == 'd') || (c == 'u');}
+  static constexpr size_t slotCount(const char* f, size_t i=0) {
+    return ((f[i] == '\0')?(0):
+           ((f[i] != '%')?(slotCount(f,i+1)):
+           ((isSlot(f[i+1]))?(1+slotCount(f,i+2)):(html_template_format_does_not_match_arguments()))));
+  }
+  static constexpr size_t slotPos(const char* f, size_t k, size_t i=0) {
+    return ((f[i] != '%')?(slotPos(f,k,i+1)):((k == 0)?(i):(slotPos(f,k-1,i+2))));
+  }
+  static constexpr char   slotType(const char* f, size_t k)              {return f[slotPos(f,k)+1];}
+  static constexpr size_t segStart(const char* f, size_t k)              {return ((k == 0)?(0):(slotPos(f,k-1)+2));}
+  static constexpr size_t segEnd(const char* f, size_t k, size_t n, size_t len) {return ((k == n)?(len):(slotPos(f,k)));}
+};
+
+/**
+ *   Slot types. Each supported argument type declares the conversion it fills, its rendered length, and how it is
+ *   written.
+ */
+template<typename T> struct TemplateSlot;
+
+template<> struct TemplateSlot<const char*> {
+  static constexpr bool accepts(char c)                                  {return c == 's';}
+  static size_t         length(const char* v)                            {return ((v != NULL)?(strlen(v)):(0));}
+  template<typename Sink>
+  static void           write(Sink& s, const char* v)                    {if( v != NULL ) s.write(v,strlen(v));}
+};
+
+template<> struct TemplateSlot<unsigned int> {
+  static constexpr bool accepts(char c)                                  {return c == 'u';}
+  static size_t         length(unsigned int v)                           {size_t n = 1; while( v >= 10 ) {v /= 10; n++;} return n;}
+  static size_t         format(unsigned int v, char* end)                {char* p = end; do {*--p = '0' + v%10; v /= 10;} while( v != 0 ); return end-p;}
+  template<typename Sink>
+  static void           write(Sink& s, unsigned int v)                   {char b[12]; size_t n = format(v,b+sizeof(b)); s.write(b+sizeof(b)-n,n);}
+};
+
+template<> struct TemplateSlot<int> {
+  static constexpr bool accepts(char c)                                  {return c == 'd';}
+  static unsigned int   magnitude(int v)                                 {return ((v < 0)?(0U-(unsigned int)v):((unsigned int)v));}
+  static size_t         length(int v)                                    {return TemplateSlot<unsigned int>::length(magnitude(v)) + ((v < 0)?(1):(0));}
+  template<typename Sink>
+  static void           write(Sink& s, int v) {
+    char   b[12];
+    size_t n = TemplateSlot<unsigned int>::format(magnitude(v),b+sizeof(b));
+    if( v < 0 ) b[sizeof(b)-(++n)] = '-';
+    s.write(b+sizeof(b)-n,n);
+  }
+};
+
+template<typename... A> struct TemplateSlots;
+
+template<> struct TemplateSlots<> {
+  static constexpr bool   check(const char*, size_t)                     {return true;}
+  static size_t           length()                                       {return 0;}
+};
+
+template<typename T, typename... R> struct TemplateSlots<T,R...> {
+  static constexpr bool   check(const char* f, size_t k)                 {return TemplateSlot<T>::accepts(TemplateFormat::slotType(f,k)) && TemplateSlots<R...>::check(f,k+1);}
+  static size_t           length(T v, R... rest)                         {return TemplateSlot<T>::length(v) + TemplateSlots<R...>::length(rest...);}
+};
+
+template<size_t... I> struct TemplateIndices {};
+template<size_t N, size_t... I> struct MakeTemplateIndices : MakeTemplateIndices<N-1,N-1,I...> {};
+template<size_t... I> struct MakeTemplateIndices<0,I...> {typedef TemplateIndices<I...> type;};
+
+template<typename... Args>
+class HtmlTemplate {
+  public:
+  template<size_t N>
+  constexpr HtmlTemplate(const char (&format)[N]) : HtmlTemplate(format,N-1,typename MakeTemplateIndices<sizeof...(Args)+1>::type()) {}
+
+/**
+ *   Exact number of bytes render() will write for args, not including a '\0' terminator
+ */
+  size_t      length(Args... args) const                                 {return _literal + TemplateSlots<Args...>::length(args...);}
+  constexpr size_t literalLength() const                                 {return _literal;}
+  constexpr PGM_P  format() const                                        {return _format;}
+
+  template<typename Sink>
+  void        render(Sink& s, Args... args) const                        {emit(s,0,args...);}
+
+/**
+ *   Render into buffer at pos with the same conventions as formatBuffer_P(), returning the updated position
+ */
+  int         render(char buffer[], int size, int pos, Args... args) const {
+    int result = size;
+    if( (pos >= 0) && (pos < size-1) ) {BufferBuilder b(buffer,size,pos); emit(b,0,args...); result = b.position();}
+    return result;
+  }
+
+  private:
+  struct Segment {
+    uint16_t start;
+    uint16_t len;
+  };
+
+  template<size_t... I>
+  constexpr HtmlTemplate(const char* format, size_t len, TemplateIndices<I...>) :
+    _format(format),
+    _literal(((TemplateFormat::slotCount(format) == sizeof...(Args)) && TemplateSlots<Args...>::check(format,0))?
+             (len - 2*sizeof...(Args)):(html_template_format_does_not_match_arguments())),
+    _seg{Segment{(uint16_t)TemplateFormat::segStart(format,I),
+                 (uint16_t)(TemplateFormat::segEnd(format,I,sizeof...(Args),len)-TemplateFormat::segStart(format,I))}...} {}
+
+  template<typename Sink>
+  void        emit(Sink& s, size_t k) const                              {if( _seg[k].len > 0 ) s.write_P(_format+_seg[k].start,_seg[k].len);}
+
+  template<typename Sink, typename T, typename... R>
+  void        emit(Sink& s, size_t k, T v, R... rest) const              {emit(s,k); TemplateSlot<T>::write(s,v); emit(s,k+1,rest...);}
+
+  PGM_P       _format;
+  size_t      _literal;
+  Segment     _seg[sizeof...(Args)+1];
+};
+
+/**
+ *   Typed templates for the CommonProgmem.h templates
+ */
+constexpr HtmlTemplate<const char*>                    error_html_tmpl(error_html);
+constexpr HtmlTemplate<>                               html_header_tmpl(html_header);
+constexpr HtmlTemplate<const char*>                    html_title_tmpl(html_title);
+constexpr HtmlTemplate<const char*>                    html_L2_title_tmpl(html_L2_title);
+constexpr HtmlTemplate<const char*>                    html_L3_title_tmpl(html_L3_title);
+constexpr HtmlTemplate<>                               html_tail_tmpl(html_tail);
+constexpr HtmlTemplate<const char*,int,int>            iframe_html_tmpl(iframe_html);
+constexpr HtmlTemplate<const char*>                    html_NotFound_tmpl(html_NotFound);
+constexpr HtmlTemplate<const char*>                    nearby_html_tmpl(nearby_html);
+constexpr HtmlTemplate<const char*,const char*>        app_button_tmpl(app_button);
+constexpr HtmlTemplate<const char*,const char*>        small_button_tmpl(small_button);
+constexpr HtmlTemplate<const char*,const char*>        config_button_tmpl(config_button);
+constexpr HtmlTemplate<int,int,int,int,int>            loc_template_tmpl(loc_template);
+
+} // End of namespace lsc
+
+#endif
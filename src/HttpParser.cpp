@@ -0,0 +1,287 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "HttpParser.h"
+#include "UrlCodec.h"
+#include <ctype.h>
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+void HttpParser::reset() {
+  _len           = 0;
+  _scan          = 0;
+  _searched      = 0;
+  _bodyStart     = 0;
+  _contentLength = 0;
+  _pipelined     = 0;
+  _consumed      = 0;
+  _streamed      = false;
+  _state         = HTTP_REQUEST_LINE;
+  _error         = 0;
+  _keepAlive     = false;
+  _method        = Span();
+  _path          = Span();
+  _query         = Span();
+  _version       = Span();
+  _headerCount   = 0;
+  _argCount      = 0;
+}
+
+HttpParseState HttpParser::next() {
+  if( _state != HTTP_COMPLETE ) {reset(); return _state;}
+  size_t rest = _len - _pipelined;
+  memmove(_buffer,_buffer+_pipelined,rest);
+  reset();
+  _len = rest;
+  return ((rest > 0)?(parse()):(_state));
+}
+
+HttpParseState HttpParser::received(size_t n) {
+  size_t avail;
+  space(avail);
+  _len += ((n < avail)?(n):(avail));
+  return (((_state == HTTP_COMPLETE) || (_state == HTTP_ERROR))?(_state):(parse()));
+}
+
+HttpParseState HttpParser::feed(const char* data, size_t len) {
+  do {
+    size_t avail;
+    char*  to = space(avail);
+    size_t n  = ((len < avail)?(len):(avail));
+    memcpy(to,data,n);
+    received(n);
+    data += n;
+    len  -= n;
+    if( n == 0 ) break;
+  } while( (len > 0) && (_state != HTTP_COMPLETE) && (_state != HTTP_ERROR) );
+  return _state;
+}
+
+/**
+ *   Scan complete lines from where the last arrival stopped. Lines end in CRLF or a bare LF, and the end of each is
+ *   overwritten with '\0'. Empty lines before the request line are skipped, as RFC 9112 allows.
+ */
+HttpParseState HttpParser::parse() {
+  while( (_state == HTTP_REQUEST_LINE) || (_state == HTTP_HEADERS) ) {
+    char* start = _buffer + _scan;
+    char* eol   = (char*)memchr(_buffer + _searched,'\n',_len - _searched);
+    if( eol == NULL ) {
+      _searched = _len;
+      return ((_len >= HTTP_MAX_REQUEST)?(fail(((_state == HTTP_REQUEST_LINE)?(414):(431)))):(_state));
+    }
+    size_t len = eol - start;
+    if( (len > 0) && (start[len-1] == '\r') ) len--;
+    start[len] = '\0';
+    _scan      = eol + 1 - _buffer;
+    _searched  = _scan;
+    if( _state == HTTP_REQUEST_LINE ) {
+      if( (len > 0) && requestLine(start,len) ) _state = HTTP_HEADERS;
+    }
+    else if( len == 0 ) endOfHead();
+    else                headerLine(start,len);
+  }
+  if( (_state == HTTP_BODY) && (_len >= _bodyStart + _contentLength) ) finish();
+  return _state;
+}
+
+/**
+ *   METHOD SP target SP HTTP/1.x, with the target split at '?' into path and query
+ */
+bool HttpParser::requestLine(char* line, size_t len) {
+  char* end    = line + len;
+  char* target = (char*)memchr(line,' ',len);
+  if( (target == NULL) || (target == line) ) {fail(400); return false;}
+  for( char* p=line; p<target; p++ ) {if( !isupper((unsigned char)*p) && (*p != '-') && (*p != '_') ) {fail(400); return false;}}
+  *target++ = '\0';
+  char* version = (char*)memchr(target,' ',end-target);
+  if( (version == NULL) || (version == target) ) {fail(400); return false;}
+  for( char* p=target; p<version; p++ ) {if( ((unsigned char)*p <= ' ') || (*p == 0x7F) ) {fail(400); return false;}}
+  *version++ = '\0';
+  if( (end-version != 8) || (strncmp(version,"HTTP/1.",7) != 0) || !isdigit((unsigned char)version[7]) ) {
+    fail(((strncmp(version,"HTTP/",5) == 0)?(505):(400)));
+    return false;
+  }
+  char* query = (char*)memchr(target,'?',(version-1)-target);
+  if( query != NULL ) {
+    *query = '\0';
+    _query = span(query+1,(version-1)-(query+1));
+  }
+  _method    = span(line,(target-1)-line);
+  _path      = span(target,((query != NULL)?(query):(version-1))-target);
+  _version   = span(version,8);
+  _keepAlive = (version[7] != '0');
+  return true;
+}
+
+/**
+ *   name: value, with the name ending at the colon and the value trimmed of spaces and tabs. Whitespace before the
+ *   colon and obsolete line folding are rejected, as RFC 9112 requires of servers.
+ */
+bool HttpParser::headerLine(char* line, size_t len) {
+  char* end   = line + len;
+  char* colon = (char*)memchr(line,':',len);
+  if( (colon == NULL) || (colon == line) ) {fail(400); return false;}
+  for( char* p=line; p<colon; p++ ) {if( ((unsigned char)*p <= ' ') || (*p == 0x7F) ) {fail(400); return false;}}
+  if( _headerCount == HTTP_MAX_HEADERS ) {fail(431); return false;}
+  char* value = colon + 1;
+  while( (value < end) && ((*value == ' ') || (*value == '\t')) ) value++;
+  while( (end > value) && ((end[-1] == ' ') || (end[-1] == '\t')) ) end--;
+  *colon = '\0';
+  *end   = '\0';
+  _headers[_headerCount].name  = span(line,colon-line);
+  _headers[_headerCount].value = span(value,end-value);
+  _headerCount++;
+  return true;
+}
+
+/**
+ *   Apply Content-Length, Transfer-Encoding and Connection once the head is complete. Conflicting lengths are
+ *   rejected rather than one chosen, so a proxy in front cannot be made to see a different request boundary.
+ */
+bool HttpParser::endOfHead() {
+  bool length = false;
+  _bodyStart     = _scan;
+  _contentLength = 0;
+  for( int i=0; i<_headerCount; i++ ) {
+    const char* name  = text(_headers[i].name);
+    const char* value = text(_headers[i].value);
+    size_t      len   = _headers[i].value.length;
+    if( strcasecmp(name,"Content-Length") == 0 ) {
+      if( (len == 0) || (strspn(value,"0123456789") != len) ) {fail(400); return false;}
+      if( len > 9 ) {fail(413); return false;}
+      size_t n = strtoul(value,NULL,10);
+      if( length && (n != _contentLength) ) {fail(400); return false;}
+      _contentLength = n;
+      length         = true;
+    }
+    else if( strcasecmp(name,"Transfer-Encoding") == 0 ) {fail(501); return false;}
+    else if( strcasecmp(name,"Connection") == 0 ) {
+      if( strncasecmp(value,"close",5) == 0 )           _keepAlive = false;
+      else if( strncasecmp(value,"keep-alive",10) == 0 ) _keepAlive = true;
+    }
+  }
+  head();
+  if( (_contentLength > 0) && (_stream != NULL) && _stream(*this) ) {
+    _streamed = true;
+    _state    = HTTP_STREAM;
+    return true;
+  }
+  if( _contentLength > HTTP_MAX_REQUEST - _bodyStart ) {fail(413); return false;}
+  _state = HTTP_BODY;
+  return true;
+}
+
+/**
+ *   Decode the path and query arguments in place. '+' is a space only in the query, so it is kept in the path.
+ */
+void HttpParser::head() {
+  if( _path.length > 0 ) _path.length = urlDecode(_buffer+_path.offset,false);
+  if( _query.length > 0 ) parseArgs(_buffer+_query.offset,_query.length);
+}
+
+const char* HttpParser::bodyData(size_t& len) const {
+  len = 0;
+  if( !_streamed || (_len <= _bodyStart) ) return NULL;
+  len = _len - _bodyStart;
+  if( len > bodyRemaining() ) len = bodyRemaining();
+  return ((len > 0)?(_buffer + _bodyStart):(NULL));
+}
+
+/**
+ *   Move the rest of the buffer down over n consumed body bytes. Once the whole body is consumed the request is
+ *   complete, with bytes after it pipelined.
+ */
+HttpParseState HttpParser::consume(size_t n) {
+  if( _state != HTTP_STREAM ) return _state;
+  size_t len;
+  bodyData(len);
+  if( n > len ) n = len;
+  memmove(_buffer+_bodyStart,_buffer+_bodyStart+n,_len-_bodyStart-n);
+  _len      -= n;
+  _consumed += n;
+  if( _consumed == _contentLength ) {
+    _pipelined = _bodyStart;
+    _state     = HTTP_COMPLETE;
+  }
+  return _state;
+}
+
+/**
+ *   Terminate the body, moving pipelined bytes up one to make room, then decode form arguments in place. The
+ *   terminator stays part of the buffer so bytes arriving later cannot overwrite it.
+ */
+void HttpParser::finish() {
+  size_t end = _bodyStart + _contentLength;
+  _pipelined = end;
+  if( _contentLength > 0 ) {
+    memmove(_buffer+end+1,_buffer+end,_len-end);
+    _buffer[end] = '\0';
+    _len++;
+    _pipelined++;
+  }
+  if( is("POST") && (_contentLength > 0) ) {
+    const char* type = header("Content-Type");
+    if( strncasecmp(type,"application/x-www-form-urlencoded",33) == 0 ) parseArgs(_buffer+_bodyStart,_contentLength);
+    else if( _argCount < HTTP_MAX_ARGS ) {
+      _args[_argCount].name.offset = PLAIN_ARG;
+      _args[_argCount].name.length = 5;
+      _args[_argCount].value       = span(_buffer+_bodyStart,_contentLength);
+      _argCount++;
+    }
+  }
+  _state = HTTP_COMPLETE;
+}
+
+/**
+ *   Split name=value pairs at '&' and '=' in place and URL decode each. str[len] must be '\0'.
+ */
+void HttpParser::parseArgs(char* str, size_t len) {
+  char* end = str + len;
+  while( str < end ) {
+    char* next = (char*)memchr(str,'&',end-str);
+    if( next == NULL ) next = end;
+    *next = '\0';
+    if( (next > str) && (_argCount < HTTP_MAX_ARGS) ) {
+      char* value = (char*)memchr(str,'=',next-str);
+      if( value != NULL ) *value++ = '\0';
+      _args[_argCount].name  = span(str,urlDecode(str));
+      _args[_argCount].value = ((value != NULL)?(span(value,urlDecode(value))):(Span()));
+      _argCount++;
+    }
+    str = next + 1;
+  }
+}
+
+int HttpParser::headerIndex(const char* name) const {
+  for( int i=0; i<_headerCount; i++ ) {if( strcasecmp(text(_headers[i].name),name) == 0 ) return i;}
+  return -1;
+}
+
+int HttpParser::argIndex(const char* name) const {
+  for( int i=0; i<_argCount; i++ ) {if( strcmp(argName(i),name) == 0 ) return i;}
+  return -1;
+}
+
+} // End of namespace lsc
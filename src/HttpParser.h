@@ -0,0 +1,208 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Incremental HTTP/1.x request parser over a single fixed receive buffer. Bytes are read straight into the buffer,
+ *  and each arrival is scanned once, from where the previous one stopped, so a request split over many reads costs
+ *  no more than one that arrives whole:
+ *
+ *    size_t avail;
+ *    char*  space = parser.space(avail);
+ *    int    n     = client.read((uint8_t*)space,avail);
+ *    if( parser.received(n) == HTTP_COMPLETE ) ...
+ *
+ *  The method, path, query, headers, body and arguments are recorded as offsets into the buffer rather than copied.
+ *  Delimiters are overwritten in place, so every accessor returns a '\0' terminated string in the buffer, valid until
+ *  next() or reset(). The path and arguments are URL decoded in place once the request is complete. Every header is
+ *  kept, so header(name) needs no list of headers collected beforehand. Nothing is allocated.
+ *
+ *  A request that breaks the syntax or a limit moves the parser to HTTP_ERROR, with error() giving the status to
+ *  answer with: 400 malformed, 413 body too large, 414 request line too long, 431 too many headers or head too large,
+ *  501 Transfer-Encoding, and 505 unsupported HTTP version. Bytes pipelined after a request are kept for next().
+ *
+ *  A body too large for the buffer can be streamed instead. The stream function is asked once the head is parsed,
+ *  with the path and query arguments decoded, and if it returns true the body is not collected. The parser moves to
+ *  HTTP_STREAM, and the body is read from bodyData() and released with consume() as it arrives, one buffer at a
+ *  time, until the last byte is consumed and the request is complete:
+ *
+ *    parser.setStreamFunction([](const HttpParser& p){return strcmp(p.path(),"/upload") == 0;});
+ *    ...
+ *    while( (data = parser.bodyData(len)) != NULL ) parser.consume(write(data,len));
+ */
+
+#ifndef HTTP_PARSER_H
+#define HTTP_PARSER_H
+
+#include "CommonProgmem.h"
+#include <functional>
+
+#ifndef HTTP_MAX_REQUEST
+#ifdef LSC_HOST
+#define HTTP_MAX_REQUEST     8192                // Receive buffer, request head and body together
+#else
+#define HTTP_MAX_REQUEST     2048
+#endif
+#endif
+#ifndef HTTP_MAX_HEADERS
+#define HTTP_MAX_HEADERS     24
+#endif
+#ifndef HTTP_MAX_ARGS
+#define HTTP_MAX_ARGS        32                  // Further arguments are ignored
+#endif
+#define HTTP_MAX_BODY        999999999           // Largest Content-Length, streamed
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+static_assert(HTTP_MAX_REQUEST < 0xFFFF,"HttpParser offsets are 16 bit");
+
+enum HttpParseState {HTTP_REQUEST_LINE, HTTP_HEADERS, HTTP_BODY, HTTP_STREAM, HTTP_COMPLETE, HTTP_ERROR};
+
+class HttpParser;
+typedef std::function<bool(const HttpParser& p)> StreamFunction;                 // True to stream the body of request p
+
+class HttpParser {
+  public:
+  HttpParser()                                                   {reset();}
+
+  void           setStreamFunction(StreamFunction f)             {_stream = f;}
+
+/**
+ *   Discard everything buffered, or only the completed request, keeping and parsing bytes pipelined after it
+ */
+  void           reset();
+  HttpParseState next();
+
+/**
+ *   Free space at the end of the buffer for the next read, and the number of bytes written there by it. feed()
+ *   copies len bytes in instead, returning the state after as many as fit.
+ */
+  char*          space(size_t& avail)                            {avail = ((_len < HTTP_MAX_REQUEST)?(HTTP_MAX_REQUEST - _len):(0)); return _buffer + _len;}
+  HttpParseState received(size_t n);
+  HttpParseState feed(const char* data, size_t len);
+
+  HttpParseState state() const                                   {return _state;}
+  bool           complete() const                                {return _state == HTTP_COMPLETE;}
+  bool           failed() const                                  {return _state == HTTP_ERROR;}
+  int            error() const                                   {return _error;}
+  size_t         buffered() const                                {return _len;}
+
+/**
+ *   Bytes of the buffer held by the complete request, those after it being pipelined
+ */
+  size_t         length() const                                  {return _pipelined;}
+
+  const char*    method() const                                  {return text(_method);}
+  const char*    path() const                                    {return text(_path);}
+  const char*    version() const                                 {return text(_version);}
+  bool           is(const char* method) const                    {return strcmp(text(_method),method) == 0;}
+
+/**
+ *   True if the client asked for a persistent connection, by default for HTTP/1.1 and with Connection: keep-alive
+ *   for HTTP/1.0
+ */
+  bool           keepAlive() const                               {return _keepAlive;}
+
+  int            headerCount() const                             {return _headerCount;}
+  const char*    headerName(int i) const                         {return (((i >= 0) && (i < _headerCount))?(text(_headers[i].name)):(""));}
+  const char*    headerValue(int i) const                        {return (((i >= 0) && (i < _headerCount))?(text(_headers[i].value)):(""));}
+  size_t         headerLength(int i) const                       {return (((i >= 0) && (i < _headerCount))?(_headers[i].value.length):(0));}
+  int            headerIndex(const char* name) const;
+  const char*    header(const char* name) const                  {return headerValue(headerIndex(name));}
+
+  size_t         contentLength() const                           {return _contentLength;}
+  const char*    body() const                                    {return (((_contentLength > 0) && !_streamed)?(_buffer + _bodyStart):(""));}
+
+/**
+ *   A streamed body: the bytes buffered and not yet consumed, or NULL if there are none, and how many of the
+ *   Content-Length bytes are still to be consumed. consume(n) releases the first n bytes of bodyData(), making room
+ *   for more, and returns the state after.
+ */
+  bool           streamed() const                                {return _streamed;}
+  const char*    bodyData(size_t& len) const;
+  size_t         bodyRemaining() const                           {return _contentLength - _consumed;}
+  HttpParseState consume(size_t n);
+
+/**
+ *   Arguments from the query and from an application/x-www-form-urlencoded POST body, URL decoded. Any other POST
+ *   body is the value of a single argument named "plain", as ESP8266WebServer has it.
+ */
+  int            argCount() const                                {return _argCount;}
+  const char*    argName(int i) const                            {return (((i >= 0) && (i < _argCount))?(((_args[i].name.offset == PLAIN_ARG))?("plain"):(text(_args[i].name))):(""));}
+  const char*    arg(int i) const                                {return (((i >= 0) && (i < _argCount))?(text(_args[i].value)):(""));}
+  size_t         argNameLength(int i) const                      {return (((i >= 0) && (i < _argCount))?(_args[i].name.length):(0));}
+  size_t         argLength(int i) const                          {return (((i >= 0) && (i < _argCount))?(_args[i].value.length):(0));}
+  int            argIndex(const char* name) const;
+
+  private:
+  struct Span {
+    uint16_t     offset = 0;
+    uint16_t     length = 0;
+  };
+  struct Field {
+    Span         name;
+    Span         value;
+  };
+
+  static const uint16_t PLAIN_ARG = 0xFFFF;                      // Name offset of the "plain" argument
+
+  const char*    text(const Span& s) const                       {return ((s.length > 0)?(_buffer + s.offset):(""));}
+  Span           span(const char* start, size_t len) const       {Span s; s.offset = start - _buffer; s.length = len; return s;}
+  HttpParseState fail(int status)                                {_error = status; _state = HTTP_ERROR; return _state;}
+  HttpParseState parse();
+  bool           requestLine(char* line, size_t len);
+  bool           headerLine(char* line, size_t len);
+  bool           endOfHead();
+  void           head();
+  void           finish();
+  void           parseArgs(char* str, size_t len);
+
+  char           _buffer[HTTP_MAX_REQUEST+1];                    // One spare byte to terminate a body or the last line
+  size_t         _len           = 0;
+  size_t         _scan          = 0;                             // Start of the line being scanned for
+  size_t         _searched      = 0;                             // End of bytes already searched for its '\n'
+  size_t         _bodyStart     = 0;
+  size_t         _contentLength = 0;
+  size_t         _pipelined     = 0;                             // Start of bytes after the complete request
+  size_t         _consumed      = 0;                             // Body bytes consumed, when streamed
+  bool           _streamed      = false;
+  StreamFunction _stream        = NULL;
+  HttpParseState _state         = HTTP_REQUEST_LINE;
+  int            _error         = 0;
+  bool           _keepAlive     = false;
+  Span           _method;
+  Span           _path;
+  Span           _query;
+  Span           _version;
+  Field          _headers[HTTP_MAX_HEADERS];
+  int            _headerCount   = 0;
+  Field          _args[HTTP_MAX_ARGS];
+  int            _argCount      = 0;
+
+  HttpParser(const HttpParser&) = delete;
+  HttpParser& operator=(const HttpParser&) = delete;
+};
+
+} // End of namespace lsc
+
+#endif
@@ -0,0 +1,157 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "Logger.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+Logger Log;
+
+static const char* levelNames[] = {"NONE","WARNING","INFO","FINE","FINEST"};
+
+void LogRecord::add(const char* v) {
+  if( argc >= LOG_MAX_ARGS ) return;
+  if( v == NULL ) v = "(null)";
+  size_t room = sizeof(text) - textLen;
+  size_t len  = strlen(v);
+  if( len >= room ) len = ((room > 0)?(room-1):(0));
+  types[argc]       = ARG_TEXT;
+  args[argc++].text = ((room > 0)?(textLen):(sizeof(text)-1));
+  if( room > 0 ) {
+    memcpy(text+textLen,v,len);
+    textLen += len;
+    text[textLen++] = '\0';
+  }
+}
+
+/**
+ *  One conversion, spec holding the full "%...c" specification, with argument i as it was captured
+ */
+size_t LogRecord::formatArg(char buffer[], size_t size, const char* spec, int i) const {
+  int n = 0;
+  switch( types[i] ) {
+    case ARG_INT:     n = snprintf(buffer,size,spec,args[i].i); break;
+    case ARG_UINT:    n = snprintf(buffer,size,spec,args[i].u); break;
+    case ARG_LONG:    n = snprintf(buffer,size,spec,args[i].l); break;
+    case ARG_ULONG:   n = snprintf(buffer,size,spec,args[i].ul); break;
+    case ARG_LLONG:   n = snprintf(buffer,size,spec,args[i].ll); break;
+    case ARG_ULLONG:  n = snprintf(buffer,size,spec,args[i].ull); break;
+    case ARG_DOUBLE:  n = snprintf(buffer,size,spec,args[i].d); break;
+    case ARG_POINTER: n = snprintf(buffer,size,spec,args[i].p); break;
+    case ARG_TEXT:    n = snprintf(buffer,size,spec,text+args[i].text); break;
+  }
+  return (((n < 0) || (size == 0))?(0):((((size_t)n < size)?((size_t)n):(size-1))));
+}
+
+/**
+ *  The format is read from PROGMEM a byte at a time and split at each conversion, so every argument goes to
+ *  snprintf on its own with the specification the caller wrote. A conversion without a captured argument, or
+ *  one that writes to its argument (%n), is copied as text.
+ */
+size_t LogRecord::render(char buffer[], size_t size) const {
+  if( size == 0 ) return 0;
+  int    n   = snprintf(buffer,size,"%lu %s ",time,levelNames[((level <= FINEST)?((LoggingLevel)level):(NONE))]);
+  size_t pos = (((n < 0) || ((size_t)n >= size))?(size-1):((size_t)n));
+  const char* f = format;
+  int  arg = 0;
+  char c;
+  while( ((c = (char)pgm_read_byte(f)) != '\0') && (pos+1 < size) ) {
+    f++;
+    if( c != '%' ) {buffer[pos++] = c; continue;}
+    char spec[16];
+    int  len = 0;
+    spec[len++] = c;
+    while( ((c = (char)pgm_read_byte(f)) != '\0') && (len < (int)sizeof(spec)-1) ) {
+      spec[len++] = c;
+      f++;
+      if( strchr("diouxXeEfFgGaAcspn%",c) != NULL ) break;
+    }
+    spec[len] = '\0';
+    if( (c == '%') && (len == 2) ) buffer[pos++] = '%';
+    else if( (c != 'n') && (c != '\0') && (arg < argc) ) pos += formatArg(buffer+pos,size-pos,spec,arg++);
+    else {
+      size_t k = strlcpy(buffer+pos,spec,size-pos);
+      pos += ((k < size-pos)?(k):(size-pos-1));
+    }
+  }
+  buffer[pos] = '\0';
+  return pos;
+}
+
+int Logger::drain(int max) {
+  char line[LOG_LINE_BYTES];
+  int  count = 0;
+  LogRecord r;
+  while( (count < max) && _ring.pop(r) ) {
+    size_t len = r.render(line,sizeof(line));
+    if( _output != NULL ) _output(line,len);
+    else                  Serial.println(line);
+    remember(line,len);
+    count++;
+  }
+  return count;
+}
+
+/**
+ *  Append line and '\n' to the history ring, overwriting the oldest text
+ */
+void Logger::remember(const char* line, size_t len) {
+#if LOG_HISTORY_BYTES > 0
+  LOG_LOCK;
+  for( size_t i=0; i<=len; i++ ) _history[(_historyEnd++) % LOG_HISTORY_BYTES] = ((i < len)?(line[i]):('\n'));
+#else
+  (void)line;
+  (void)len;
+#endif
+}
+
+/**
+ *  Once the ring has wrapped its oldest line is partly overwritten, so the dump starts after the first '\n'
+ */
+void Logger::history(LogOutputFunction f) {
+#if LOG_HISTORY_BYTES > 0
+  LOG_LOCK;
+  if( _historyEnd <= LOG_HISTORY_BYTES ) {
+    if( _historyEnd > 0 ) f(_history,_historyEnd);
+    return;
+  }
+  size_t start = _historyEnd % LOG_HISTORY_BYTES;
+  size_t skip  = start;
+  while( (skip < LOG_HISTORY_BYTES) && (_history[skip] != '\n') ) skip++;
+  if( skip < LOG_HISTORY_BYTES ) {
+    if( skip+1 < LOG_HISTORY_BYTES ) f(_history+skip+1,LOG_HISTORY_BYTES-skip-1);
+    if( start > 0 ) f(_history,start);
+  }
+  else {
+    skip = 0;
+    while( (skip < start) && (_history[skip] != '\n') ) skip++;
+    if( skip+1 < start ) f(_history+skip+1,start-skip-1);
+  }
+#else
+  (void)f;
+#endif
+}
+
+} // End of namespace lsc
@@ -0,0 +1,239 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Deferred logger for request paths. A log statement copies its format pointer, arguments and a timestamp into a
+ *  fixed size binary record on a lock-free ring, and formatting and output to Serial happen later, when loop()
+ *  calls drain(), so handlers never wait on the UART. Statements above LOG_LEVEL are removed by the preprocessor,
+ *  arguments included, and the rest are filtered at run time with setLevel() before their arguments are evaluated.
+ *  For example:
+ *
+ *    LOG_INFO("handleDevice %s sent %d bytes",c->uri().c_str(),(int)w.bytesWritten());
+ *    ...
+ *    void loop() {ctx.handleClient(); Log.drain();}
+ *
+ *  The format must be a string literal, it is kept in PROGMEM and read at drain time. Arguments are checked against
+ *  it at compile time as for printf, so Strings are passed with c_str(). String arguments are copied into the
+ *  record, up to LOG_TEXT_BYTES per record, and '*' widths are not supported. Records that find the ring
+ *  full are dropped and counted, see dropped(). Drained lines are also kept in a history of LOG_HISTORY_BYTES,
+ *  dumped over HTTP by WebContext::enableLog(), which is off by default on ESP8266.
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "CommonProgmem.h"
+#include "CommonDef.h"
+#include <functional>
+
+#if defined(LSC_HOST) || defined(ESP32)
+#include <mutex>
+#include "WorkQueue.h"
+#define LOG_LOCK             std::lock_guard<std::mutex> lock(_lock)
+#else
+#define LOG_LOCK
+#endif
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL            2                   // Compile time threshold, as LoggingLevel: 0 NONE, 1 WARNING, 2 INFO, 3 FINE, 4 FINEST
+#endif
+#ifndef LOG_RECORDS
+#ifdef ESP8266
+#define LOG_RECORDS          16                  // Ring capacity in records, a power of 2
+#else
+#define LOG_RECORDS          32
+#endif
+#endif
+#ifndef LOG_HISTORY_BYTES
+#ifdef ESP8266
+#define LOG_HISTORY_BYTES    0                   // Off unless defined, as Log takes DRAM in every ESP8266 sketch
+#else
+#define LOG_HISTORY_BYTES    1024                // Drained text kept for the log route, 0 for none
+#endif
+#endif
+#define LOG_MAX_ARGS         6                   // Arguments captured per record
+#define LOG_TEXT_BYTES       40                  // String argument bytes per record
+#define LOG_LINE_BYTES       160                 // Longest formatted line
+
+#define LOG_CHECK(fmt,...)   if( false ) lsc::logFormat(fmt,##__VA_ARGS__)     // Checked as printf, never run
+
+#if LOG_LEVEL >= 1
+#define LOG_WARNING(fmt,...) do {LOG_CHECK(fmt,##__VA_ARGS__); if( lsc::Log.enabled(lsc::WARNING) ) lsc::Log.write(lsc::WARNING,PSTR(fmt),##__VA_ARGS__);} while(0)
+#else
+#define LOG_WARNING(fmt,...) do {} while(0)
+#endif
+#if LOG_LEVEL >= 2
+#define LOG_INFO(fmt,...)    do {LOG_CHECK(fmt,##__VA_ARGS__); if( lsc::Log.enabled(lsc::INFO) ) lsc::Log.write(lsc::INFO,PSTR(fmt),##__VA_ARGS__);} while(0)
+#else
+#define LOG_INFO(fmt,...)    do {} while(0)
+#endif
+#if LOG_LEVEL >= 3
+#define LOG_FINE(fmt,...)    do {LOG_CHECK(fmt,##__VA_ARGS__); if( lsc::Log.enabled(lsc::FINE) ) lsc::Log.write(lsc::FINE,PSTR(fmt),##__VA_ARGS__);} while(0)
+#else
+#define LOG_FINE(fmt,...)    do {} while(0)
+#endif
+#if LOG_LEVEL >= 4
+#define LOG_FINEST(fmt,...)  do {LOG_CHECK(fmt,##__VA_ARGS__); if( lsc::Log.enabled(lsc::FINEST) ) lsc::Log.write(lsc::FINEST,PSTR(fmt),##__VA_ARGS__);} while(0)
+#else
+#define LOG_FINEST(fmt,...)  do {} while(0)
+#endif
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+typedef std::function<void(const char* line, size_t len)> LogOutputFunction;     // Receives each drained line, without '\n'
+
+/**
+ *  Never called: the LOG_ macros pass their format and arguments here in dead code, so the compiler checks them
+ *  against each other as it does for printf
+ */
+inline void logFormat(const char* format, ...) __attribute__((format(printf,1,2)));
+inline void logFormat(const char*, ...) {}
+
+/**
+ *  One log statement as captured: the arguments keep their C types, so each is passed back to printf as the
+ *  caller passed it. String arguments are held as offsets into text.
+ */
+struct LogRecord {
+  enum ArgType : uint8_t {ARG_INT, ARG_UINT, ARG_LONG, ARG_ULONG, ARG_LLONG, ARG_ULLONG, ARG_DOUBLE, ARG_POINTER, ARG_TEXT};
+  union Arg {
+    int                 i;
+    unsigned int        u;
+    long                l;
+    unsigned long       ul;
+    long long           ll;
+    unsigned long long  ull;
+    double              d;
+    const void*         p;
+    uint16_t            text;
+  };
+
+  PGM_P         format = NULL;
+  unsigned long time   = 0;                   // millis()
+  uint8_t       level  = 0;
+  uint8_t       argc   = 0;
+  uint8_t       textLen = 0;
+  ArgType       types[LOG_MAX_ARGS];
+  Arg           args[LOG_MAX_ARGS];
+  char          text[LOG_TEXT_BYTES];
+
+  void          add(int v)                                       {if( argc < LOG_MAX_ARGS ) {types[argc] = ARG_INT; args[argc++].i = v;}}
+  void          add(unsigned int v)                              {if( argc < LOG_MAX_ARGS ) {types[argc] = ARG_UINT; args[argc++].u = v;}}
+  void          add(long v)                                      {if( argc < LOG_MAX_ARGS ) {types[argc] = ARG_LONG; args[argc++].l = v;}}
+  void          add(unsigned long v)                             {if( argc < LOG_MAX_ARGS ) {types[argc] = ARG_ULONG; args[argc++].ul = v;}}
+  void          add(long long v)                                 {if( argc < LOG_MAX_ARGS ) {types[argc] = ARG_LLONG; args[argc++].ll = v;}}
+  void          add(unsigned long long v)                        {if( argc < LOG_MAX_ARGS ) {types[argc] = ARG_ULLONG; args[argc++].ull = v;}}
+  void          add(double v)                                    {if( argc < LOG_MAX_ARGS ) {types[argc] = ARG_DOUBLE; args[argc++].d = v;}}
+  void          add(const void* v)                               {if( argc < LOG_MAX_ARGS ) {types[argc] = ARG_POINTER; args[argc++].p = v;}}
+  void          add(const char* v);
+  void          add(const String& v)                             {add(v.c_str());}
+
+/**
+ *  Format into buffer as "time LEVEL message", '\0' terminated, returning the length
+ */
+  size_t        render(char buffer[], size_t size) const;
+
+  private:
+  size_t        formatArg(char buffer[], size_t size, const char* spec, int i) const;
+};
+
+#if defined(LSC_HOST) || defined(ESP32)
+typedef WorkQueue<LogRecord,LOG_RECORDS> LogRing;
+#else
+
+/**
+ *  Single threaded ring with the interface of WorkQueue
+ */
+class LogRing {
+  public:
+  bool push(const LogRecord& r)                                  {if( _tail - _head == LOG_RECORDS ) return false; _records[_tail++ & (LOG_RECORDS-1)] = r; return true;}
+  bool pop(LogRecord& r)                                         {if( _head == _tail ) return false; r = _records[_head++ & (LOG_RECORDS-1)]; return true;}
+
+  private:
+  LogRecord     _records[LOG_RECORDS];
+  unsigned      _head = 0;
+  unsigned      _tail = 0;
+};
+#endif
+
+class Logger {
+  public:
+  Logger() {}
+
+  void          setLevel(LoggingLevel level)                     {_level = level;}
+  LoggingLevel  level() const                                    {return _level;}
+  bool          enabled(LoggingLevel level) const                {return (level <= _level) && (level != NONE);}
+  void          setOutputFunction(LogOutputFunction f)           {_output = f;}
+  unsigned long dropped() const                                  {return _dropped;}
+
+/**
+ *  Capture a statement at level if level is enabled. Called through the LOG_ macros, so format is in PROGMEM.
+ */
+  template<typename... Args>
+  void          write(LoggingLevel level, PGM_P format, const Args&... args) {
+    if( !enabled(level) ) return;
+    LogRecord r;
+    r.format = format;
+    r.time   = millis();
+    r.level  = level;
+    capture(r,args...);
+    if( !_ring.push(r) ) _dropped++;
+  }
+
+/**
+ *  Format and output up to max pending records, oldest first, returning the number drained. Output goes to
+ *  Serial unless an output function is set, and each line is added to the history.
+ */
+  int           drain(int max=LOG_RECORDS);
+
+/**
+ *  Pass the history to f, oldest line first, in at most two pieces of '\n' terminated lines
+ */
+  void          history(LogOutputFunction f);
+
+  private:
+  void          capture(LogRecord&)                              {}
+  template<typename T, typename... Args>
+  void          capture(LogRecord& r, const T& arg, const Args&... args) {r.add(arg); capture(r,args...);}
+  void          remember(const char* line, size_t len);
+
+  LogRing       _ring;
+  LoggingLevel  _level   = FINEST;             // Everything compiled in
+  LogOutputFunction _output = NULL;
+#if defined(LSC_HOST) || defined(ESP32)
+  std::atomic<unsigned long> _dropped{0};
+  std::mutex    _lock;
+#else
+  unsigned long _dropped = 0;
+#endif
+#if LOG_HISTORY_BYTES > 0
+  char          _history[LOG_HISTORY_BYTES];
+  size_t        _historyEnd = 0;                 // Total bytes ever written, the next write is at _historyEnd % LOG_HISTORY_BYTES
+#endif
+};
+
+extern Logger Log;
+
+} // End of namespace lsc
+
+#endif
@@ -0,0 +1,94 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "RequestArena.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+bool RequestArena::claim() {
+#if defined(LSC_HOST) || defined(ESP32)
+  bool expected = false;
+  if( !_claimed.compare_exchange_strong(expected,true,std::memory_order_acquire) ) return false;
+#else
+  if( _claimed ) return false;
+  _claimed = true;
+#endif
+  if( (_block == NULL) || (_capacity != _pending) ) {
+    delete [] _block;
+    _capacity = _pending;
+    _block    = ((_capacity > 0)?(new char[_capacity]):(NULL));
+  }
+  return true;
+}
+
+/**
+ *  Bump allocate from the block, or take an overflow block from the heap once the block is full
+ */
+void* RequestArena::allocate(size_t len, size_t align) {
+  size_t start = (_used + align - 1) & ~(align - 1);
+  if( (_block != NULL) && (start + len <= _capacity) ) {
+    _used = start + len;
+    if( _used + _overflowBytes > _highWater ) _highWater = _used + _overflowBytes;
+    return _block + start;
+  }
+  size_t    header = (sizeof(Overflow) + REQUEST_ARENA_ALIGN - 1) & ~(size_t)(REQUEST_ARENA_ALIGN - 1);
+  Overflow* o      = (Overflow*)malloc(header + len);
+  if( o == NULL ) return NULL;
+  o->next   = _overflow;
+  _overflow = o;
+  _overflows++;
+  _overflowBytes += len;
+  if( _used + _overflowBytes > _highWater ) _highWater = _used + _overflowBytes;
+  return ((char*)o) + header;
+}
+
+const char* RequestArena::vformat(bool progmem, const char* format, va_list args) {
+  va_list retry;
+  va_copy(retry,args);
+  size_t avail = ((_block != NULL)?(_capacity - _used):(0));
+  char*  dst   = ((_block != NULL)?(_block + _used):(NULL));
+  int    n     = (progmem?(vsnprintf_P(dst,avail,format,args)):(vsnprintf(dst,avail,format,args)));
+  char*  result = NULL;
+  if( n < 0 ) result = NULL;
+  else if( (size_t)n < avail ) result = (char*)allocate(n+1,1);
+  else {
+    result = (char*)allocate(n+1,1);
+    if( result != NULL ) {if( progmem ) vsnprintf_P(result,n+1,format,retry); else vsnprintf(result,n+1,format,retry);}
+  }
+  va_end(retry);
+  return result;
+}
+
+void RequestArena::reset() {
+  while( _overflow != NULL ) {
+    Overflow* next = _overflow->next;
+    ::free(_overflow);
+    _overflow = next;
+  }
+  _used          = 0;
+  _overflowBytes = 0;
+}
+
+} // End of namespace lsc
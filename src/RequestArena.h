@@ -0,0 +1,121 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Bump allocator for handler scratch memory, reset after each response. The block is allocated once, on first use,
+ *  and reused for every request, so handlers can build strings and buffers without sizing stack arrays for the worst
+ *  case and without leaving holes in the heap. WebContext holds one arena per thread that can dispatch at once and
+ *  hands out memory from the arena of the current request:
+ *
+ *    char*       buffer = c->scratch(1000);
+ *    const char* link   = c->format("/%s/device?ssid=%s",name,ssid);
+ *
+ *  A request that outgrows the block gets further memory from the heap, freed at reset and counted as an overflow,
+ *  so capacity can be tuned from highWater() and overflows() rather than found by crashing.
+ */
+
+#ifndef REQUEST_ARENA_H
+#define REQUEST_ARENA_H
+
+#include "CommonProgmem.h"
+#include <stdarg.h>
+
+#if defined(LSC_HOST) || defined(ESP32)
+#include <atomic>
+#endif
+
+#ifndef REQUEST_ARENA_BYTES
+#define REQUEST_ARENA_BYTES  2048                // Default arena capacity
+#endif
+#define REQUEST_ARENA_ALIGN  8                   // Alignment of allocate() by default
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+class RequestArena {
+  public:
+  RequestArena() {}
+  ~RequestArena()                                                {reset(); delete [] _block;}
+
+/**
+ *  Set capacity for the next reset, when the block is reallocated
+ */
+  void          setCapacity(size_t bytes)                        {_pending = bytes;}
+  size_t        capacity() const                                 {return _capacity;}
+  size_t        used() const                                     {return _used;}
+  size_t        highWater() const                                {return _highWater;}
+  unsigned long overflows() const                                {return _overflows;}
+
+/**
+ *  len bytes aligned to align, a power of 2, valid until reset
+ */
+  void*         allocate(size_t len, size_t align=REQUEST_ARENA_ALIGN);
+  char*         scratch(size_t len)                              {return (char*)allocate(len,1);}
+  template<typename T>
+  T*            alloc(size_t count=1)                            {return (T*)allocate(count*sizeof(T),alignof(T));}
+
+/**
+ *  printf style formatting into the arena, '\0' terminated
+ */
+  const char*   vformat(bool progmem, const char* format, va_list args);
+
+/**
+ *  Position to rewind to, so a nested request can release what it allocated without resetting the arena
+ */
+  size_t        mark() const                                     {return _used;}
+  void          rewind(size_t mark)                              {if( mark < _used ) _used = mark;}
+
+/**
+ *  Release everything allocated, including overflow blocks
+ */
+  void          reset();
+
+/**
+ *  Claim the arena for a request, false if another thread holds it
+ */
+  bool          claim();
+  void          release()                                        {reset(); _claimed = false;}
+
+  private:
+  struct Overflow {
+    Overflow*   next;
+  };
+
+  char*         _block     = NULL;
+  size_t        _capacity  = 0;
+  size_t        _pending   = REQUEST_ARENA_BYTES;
+  size_t        _used      = 0;
+  size_t        _highWater = 0;
+  size_t        _overflowBytes = 0;           // Overflow bytes of the current request, counted toward highWater
+  unsigned long _overflows = 0;
+  Overflow*     _overflow  = NULL;
+#if defined(LSC_HOST) || defined(ESP32)
+  std::atomic<bool> _claimed{false};
+#else
+  bool          _claimed   = false;
+#endif
+};
+
+} // End of namespace lsc
+
+#endif
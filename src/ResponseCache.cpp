@@ -0,0 +1,193 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "ResponseCache.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+void ResponseCapture::send(int code, const char* type, const char* content) {
+  status      = code;
+  contentType = type;
+  if( content != NULL ) sendContent(content,strlen(content));
+}
+
+void ResponseCapture::send_P(int code, PGM_P type, PGM_P content) {
+  char buffer[64];
+  status = code;
+  contentType.clear();
+  size_t len = strlen_P(type);
+  for( size_t i=0; i<len; i+=sizeof(buffer) ) {
+    size_t n = (((len-i) < sizeof(buffer))?(len-i):(sizeof(buffer)));
+    memcpy_P(buffer,type+i,n);
+    contentType.concat(buffer,n);
+  }
+  len = strlen_P(content);
+  for( size_t i=0; (i<len) && !overflow; i+=sizeof(buffer) ) {
+    size_t n = (((len-i) < sizeof(buffer))?(len-i):(sizeof(buffer)));
+    memcpy_P(buffer,content+i,n);
+    sendContent(buffer,n);
+  }
+}
+
+void ResponseCapture::sendHeader(const char* name, const char* value) {
+  headers += name;
+  headers += '\n';
+  headers += value;
+  headers += '\n';
+}
+
+void ResponseCapture::sendContent(const char* content, size_t len) {
+  if( overflow || (len == 0) ) return;
+  if( body.length() + len > _limit ) {
+    overflow = true;
+    body     = String();
+  }
+  else body.concat(content,len);
+}
+
+ResponseCache::~ResponseCache() {
+  invalidate();
+  delete [] _buckets;
+}
+
+void ResponseCache::setBudget(size_t bytes) {
+  RESPONSE_CACHE_LOCK;
+  _budget = bytes;
+  while( (_used > _budget) && (_oldest != NULL) ) {
+    Entry* e = _oldest;
+    unlink(e);
+    discard(e);
+  }
+}
+
+ResponseCache::Entry* ResponseCache::find(const String& key, uint32_t hash) {
+  Entry* e = ((_buckets != NULL)?(_buckets[hash & (RESPONSE_CACHE_BUCKETS-1)]):(NULL));
+  while( (e != NULL) && !((e->hash == hash) && e->key.equals(key)) ) e = e->chain;
+  return e;
+}
+
+const ResponseCache::Entry* ResponseCache::acquire(const String& key) {
+  RESPONSE_CACHE_LOCK;
+  Entry* e = find(key,fnv1a(key.c_str(),key.length()));
+  if( (e != NULL) && (e->ttl > 0) && (millis() - e->stored >= e->ttl) ) {
+    unlink(e);
+    discard(e);
+    e = NULL;
+  }
+  if( e == NULL ) {_misses++; return NULL;}
+  if( e != _newest ) {
+    if( e->newer != NULL ) e->newer->older = e->older;
+    if( e->older != NULL ) e->older->newer = e->newer;
+    else                   _oldest = e->newer;
+    e->newer = NULL;
+    e->older = _newest;
+    _newest->newer = e;
+    _newest  = e;
+  }
+  e->refs++;
+  _hits++;
+  return e;
+}
+
+void ResponseCache::release(const Entry* entry) {
+  if( entry == NULL ) return;
+  RESPONSE_CACHE_LOCK;
+  Entry* e = (Entry*)entry;
+  e->refs--;
+  if( !e->linked ) discard(e);
+}
+
+void ResponseCache::store(const String& key, const char* tag, unsigned long ttl, ResponseCapture& capture) {
+  size_t size = sizeof(Entry) + key.length() + capture.contentType.length() + capture.headers.length() + capture.body.length();
+  if( !capture.complete() || (size > _budget) ) return;
+  Entry* e = new Entry();
+  e->key         = key;
+  e->contentType = std::move(capture.contentType);
+  e->headers     = std::move(capture.headers);
+  e->body        = std::move(capture.body);
+  e->status      = capture.status;
+  e->tag         = tag;
+  e->stored      = millis();
+  e->ttl         = ttl;
+  e->hash        = fnv1a(key.c_str(),key.length());
+  e->size        = size;
+
+  RESPONSE_CACHE_LOCK;
+  if( _buckets == NULL ) {
+    _buckets = new Entry*[RESPONSE_CACHE_BUCKETS];
+    for( int i=0; i<RESPONSE_CACHE_BUCKETS; i++ ) _buckets[i] = NULL;
+  }
+  Entry* old = find(key,e->hash);
+  if( old != NULL ) {unlink(old); discard(old);}
+  while( (_used + size > _budget) && (_oldest != NULL) ) {
+    Entry* victim = _oldest;
+    unlink(victim);
+    discard(victim);
+  }
+  Entry** bucket = &_buckets[e->hash & (RESPONSE_CACHE_BUCKETS-1)];
+  e->chain  = *bucket;
+  *bucket   = e;
+  e->older  = _newest;
+  if( _newest != NULL ) _newest->newer = e;
+  else                  _oldest = e;
+  _newest   = e;
+  e->linked = true;
+  _used    += size;
+  _count++;
+}
+
+void ResponseCache::invalidate(const char* tag) {
+  RESPONSE_CACHE_LOCK;
+  Entry* e = _oldest;
+  while( e != NULL ) {
+    Entry* next = e->newer;
+    if( (tag == NULL) || ((e->tag != NULL) && (strcmp(e->tag,tag) == 0)) ) {
+      unlink(e);
+      discard(e);
+    }
+    e = next;
+  }
+}
+
+/**
+ *  Remove e from its bucket and the LRU list. It is deleted by discard() once no hit holds it.
+ */
+void ResponseCache::unlink(Entry* e) {
+  Entry** p = &_buckets[e->hash & (RESPONSE_CACHE_BUCKETS-1)];
+  while( *p != e ) p = &(*p)->chain;
+  *p = e->chain;
+  if( e->newer != NULL ) e->newer->older = e->older;
+  else                   _newest = e->older;
+  if( e->older != NULL ) e->older->newer = e->newer;
+  else                   _oldest = e->newer;
+  e->newer  = NULL;
+  e->older  = NULL;
+  e->chain  = NULL;
+  e->linked = false;
+  _used    -= e->size;
+  _count--;
+}
+
+} // End of namespace lsc
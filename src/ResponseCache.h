@@ -0,0 +1,149 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Cache of rendered responses for WebContext routes opted in with WebContext::cacheRoute(). Responses are keyed by
+ *  URI plus arguments sorted by name, so "/device?b=2&a=1" and "/device?a=1&b=2" share an entry. Each entry holds
+ *  status, content type, headers and body, and expires after the route's TTL or when its tag is invalidated. Total
+ *  size is bounded by a byte budget, evicting the least recently used entries to make room. For example:
+ *
+ *    ctx.on("/nearbyDevices",handleNearby);
+ *    ctx.cacheRoute("/nearbyDevices",60000,"devices");
+ *    ...
+ *    ctx.invalidateCache("devices");        // when a device joins or leaves
+ *
+ *  Entries are reference counted, so a hit is sent from the stored bytes while other threads store and evict.
+ */
+
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include "CommonProgmem.h"
+
+#if defined(LSC_HOST) || defined(ESP32)
+#include <mutex>
+#define RESPONSE_CACHE_LOCK   std::lock_guard<std::mutex> lock(_lock)
+#else
+#define RESPONSE_CACHE_LOCK
+#endif
+
+#ifndef RESPONSE_CACHE_BYTES
+#define RESPONSE_CACHE_BYTES   8192              // Default byte budget for cached responses
+#endif
+#define RESPONSE_CACHE_BUCKETS 32                // Hash buckets, a power of 2
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+/**
+ *  Response of a cached route collected as its handler sends it. Headers are held as "name\nvalue\n" lines. Once
+ *  the body passes limit bytes collection stops and the response is not cached.
+ */
+class ResponseCapture {
+  public:
+  ResponseCapture(size_t limit)                                  {_limit = limit;}
+
+  void          send(int status, const char* contentType, const char* content);
+  void          send_P(int status, PGM_P contentType, PGM_P content);
+  void          sendHeader(const char* name, const char* value);
+  void          sendContent(const char* content, size_t len);
+  bool          complete() const                                 {return (status == 200) && !overflow;}
+
+  int           status   = 0;
+  bool          overflow = false;
+  String        contentType;
+  String        headers;
+  String        body;
+
+  private:
+  size_t        _limit   = 0;
+};
+
+class ResponseCache {
+  public:
+  struct Entry {
+    String        key;
+    String        contentType;
+    String        headers;
+    String        body;
+    int           status   = 0;
+    const char*   tag      = NULL;
+    unsigned long stored   = 0;
+    unsigned long ttl      = 0;              // ms, 0 to keep until invalidated
+    uint32_t      hash     = 0;
+    size_t        size     = 0;
+    int           refs     = 0;
+    bool          linked   = false;
+    Entry*        newer    = NULL;
+    Entry*        older    = NULL;
+    Entry*        chain    = NULL;
+  };
+
+  ResponseCache() {}
+  ~ResponseCache();
+
+  void          setBudget(size_t bytes);
+  size_t        budget() const                                   {return _budget;}
+  size_t        used() const                                     {return _used;}
+  int           count() const                                    {return _count;}
+  unsigned long hits() const                                     {return _hits;}
+  unsigned long misses() const                                   {return _misses;}
+
+/**
+ *  The live entry for key, held until release(), or NULL on a miss. A hit becomes the most recently used entry.
+ */
+  const Entry*  acquire(const String& key);
+  void          release(const Entry* e);
+
+/**
+ *  Store a completed capture under key, replacing any entry for key and evicting least recently used entries to
+ *  stay within budget. A response larger than the budget is not stored.
+ */
+  void          store(const String& key, const char* tag, unsigned long ttl, ResponseCapture& capture);
+
+/**
+ *  Drop entries stored with tag, or every entry if tag is NULL
+ */
+  void          invalidate(const char* tag=NULL);
+
+  private:
+  Entry*        find(const String& key, uint32_t hash);
+  void          unlink(Entry* e);
+  void          discard(Entry* e)                                {if( e->refs == 0 ) delete e;}
+
+  Entry**       _buckets = NULL;              // Allocated on first store
+  Entry*        _newest  = NULL;
+  Entry*        _oldest  = NULL;
+  size_t        _budget  = RESPONSE_CACHE_BYTES;
+  size_t        _used    = 0;
+  int           _count   = 0;
+  unsigned long _hits    = 0;
+  unsigned long _misses  = 0;
+#if defined(LSC_HOST) || defined(ESP32)
+  std::mutex    _lock;
+#endif
+};
+
+} // End of namespace lsc
+
+#endif
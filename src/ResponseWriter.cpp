@@ -0,0 +1,227 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "ResponseWriter.h"
+#include "UrlCodec.h"
+
+/** Leelanau Software Company namespace 
+*  
+*/
+namespace lsc {
+
+/**
+ *   With unknown content length the body that follows is sent with chunked encoding, otherwise chunks are written
+ *   as they are and must add up to contentLength.
+ */
+void ResponseWriter::begin(int statusCode, PGM_P contentType, size_t contentLength) {
+  if( !_started ) {
+    char type[64];
+    strlcpy(type,"text/html",sizeof(type));
+    if( contentType != NULL ) {size_t len = strlen_P(contentType); if(len >= sizeof(type)) len = sizeof(type)-1; memcpy_P(type,contentType,len); type[len] = '\0';}
+    _ctx->setContentLength(contentLength);
+    _ctx->send(statusCode,type,"");
+    _started   = true;
+    _chunked   = (contentLength == CONTENT_LENGTH_UNKNOWN);
+    _pos       = 0;
+    _written   = 0;
+    _truncated = false;
+  }
+}
+
+int ResponseWriter::printf_P(PGM_P format, ...) {
+  va_list args;
+  va_start(args,format);
+  int result = append(true,format,args);
+  va_end(args);
+  return result;
+}
+
+int ResponseWriter::printf(const char* format, ...) {
+  va_list args;
+  va_start(args,format);
+  int result = append(false,format,args);
+  va_end(args);
+  return result;
+}
+
+int ResponseWriter::vprintf_P(PGM_P format, va_list args)     {return append(true,format,args);}
+int ResponseWriter::vprintf(const char* format, va_list args) {return append(false,format,args);}
+
+/**
+ *   Format into the remaining chunk buffer. If the fragment does not fit, the buffer is flushed and the fragment
+ *   formatted again at the start of the buffer. Returns the number of bytes appended.
+ */
+int ResponseWriter::append(bool progmem, const char* format, va_list args) {
+  if( !_started || (format == NULL) ) return 0;
+  va_list retry;
+  va_copy(retry,args);
+  size_t avail = sizeof(_buffer) - _pos;
+  int    n     = (progmem?(vsnprintf_P(_buffer+_pos,avail,format,args)):(vsnprintf(_buffer+_pos,avail,format,args)));
+  if( (n >= 0) && ((size_t)n >= avail) ) {
+    flush();
+    if( (size_t)n < sizeof(_buffer) ) n = (progmem?(vsnprintf_P(_buffer,sizeof(_buffer),format,retry)):(vsnprintf(_buffer,sizeof(_buffer),format,retry)));
+    else {n = stream(progmem,format,retry); va_end(retry); return n;}
+  }
+  va_end(retry);
+  if( n < 0 ) n = 0;
+  _pos += n;
+  return n;
+}
+
+/**
+ *   Fallback for a fragment larger than the chunk buffer. The format is walked one conversion at a time; literal
+ *   text and %s arguments are copied straight into the chunk stream and every other conversion is formatted on its
+ *   own into a small scratch buffer, so fragment size is unbounded. Returns the number of bytes appended.
+ */
+int ResponseWriter::stream(bool progmem, const char* format, va_list args) {
+  size_t      start = bytesWritten();
+  const char* p     = format;
+  char        spec[16];
+  char        tmp[64];
+  char        c     = (progmem?(pgm_read_byte(p)):(*p));
+  while( c != '\0' ) {
+    const char* lit = p;
+    while( (c != '\0') && (c != '%') ) {p++; c = (progmem?(pgm_read_byte(p)):(*p));}
+    if( p > lit ) {if(progmem) write_P(lit,p-lit); else write(lit,p-lit);}
+    if( c == '\0' ) break;
+
+    size_t n     = 0;
+    int    longs = 0;
+    bool   size  = false;
+    spec[n++] = '%';
+    do {
+      p++;
+      c = (progmem?(pgm_read_byte(p)):(*p));
+      if( c == '*' ) n += snprintf(spec+n,sizeof(spec)-n,"%d",va_arg(args,int));
+      else if( c != '\0' ) spec[n++] = c;
+      if( c == 'l' ) longs++;
+      else if( c == 'z' ) size = true;
+    } while( (c != '\0') && (strchr("diouxXcspfFeEgGaA%",c) == NULL) && (n < sizeof(spec)-1) );
+    if( n >= sizeof(spec) ) n = sizeof(spec)-1;
+    spec[n] = '\0';
+    if( c == '\0' ) break;
+    p++;
+
+    char conv = c;
+    int  len  = 0;
+    c = (progmem?(pgm_read_byte(p)):(*p));
+    switch(conv) {
+      case '%': write("%",1); break;
+      case 's': {
+        const char* str = va_arg(args,const char*);
+        if( n == 2 ) write(((str != NULL)?(str):("(null)")));
+        else         len = snprintf(tmp,sizeof(tmp),spec,str);
+        break;
+      }
+      case 'c': case 'd': case 'i':
+        if( size )           len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,ssize_t));
+        else if( longs > 1 ) len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,long long));
+        else if( longs == 1) len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,long));
+        else                 len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,int));
+        break;
+      case 'o': case 'u': case 'x': case 'X':
+        if( size )           len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,size_t));
+        else if( longs > 1 ) len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,unsigned long long));
+        else if( longs == 1) len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,unsigned long));
+        else                 len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,unsigned int));
+        break;
+      case 'p':
+        len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,void*));
+        break;
+      default:
+        len = snprintf(tmp,sizeof(tmp),spec,va_arg(args,double));
+        break;
+    }
+    if( len >= (int)sizeof(tmp) ) {_truncated = true; len = sizeof(tmp)-1;}
+    if( len > 0 ) write(tmp,len);
+  }
+  return bytesWritten() - start;
+}
+
+size_t ResponseWriter::write(const char* content, size_t len) {
+  size_t result = 0;
+  if( _started ) {
+    while( result < len ) {
+      if( _pos == sizeof(_buffer) ) flush();
+      size_t n = ((len-result < sizeof(_buffer)-_pos)?(len-result):(sizeof(_buffer)-_pos));
+      memcpy(_buffer+_pos,content+result,n);
+      _pos   += n;
+      result += n;
+    }
+  }
+  return result;
+}
+
+size_t ResponseWriter::write_P(PGM_P content, size_t len) {
+  size_t result = 0;
+  if( _started ) {
+    while( result < len ) {
+      if( _pos == sizeof(_buffer) ) flush();
+      size_t n = ((len-result < sizeof(_buffer)-_pos)?(len-result):(sizeof(_buffer)-_pos));
+      memcpy_P(_buffer+_pos,content+result,n);
+      _pos   += n;
+      result += n;
+    }
+  }
+  return result;
+}
+
+/**
+ *   Encode into the chunk buffer, flushing when the next escape does not fit. Returns the bytes of content encoded.
+ */
+size_t ResponseWriter::writeURLEncoded(const char* content, size_t len) {
+  size_t result = 0;
+  if( _started ) {
+    while( result < len ) {
+      size_t used = 0;
+      _pos   += urlEncodeChunk(_buffer+_pos,sizeof(_buffer)-_pos,content+result,len-result,used);
+      result += used;
+      if( used == 0 ) flush();
+    }
+  }
+  return result;
+}
+
+/**
+ *   Send buffered content as a single chunk
+ */
+void ResponseWriter::flush() {
+  if( _started && (_pos > 0) ) {
+    _ctx->sendContent(_buffer,_pos);
+    _written += _pos;
+    _pos      = 0;
+  }
+}
+
+/**
+ *   Flush remaining content and send the terminating zero length chunk if chunked. Called from the destructor if
+ *   necessary.
+ */
+void ResponseWriter::end() {
+  if( _started ) {
+    flush();
+    if( _chunked ) _ctx->sendContent("",0);
+    _started = false;
+  }
+}
+
+} // End of namespace lsc
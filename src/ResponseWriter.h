@@ -0,0 +1,100 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** ResponseWriter streams an HTTP response through a WebContext in fixed size chunks, using chunked transfer 
+ *  encoding, so page size is no longer bounded by a handler's stack buffer. Content is appended with the same
+ *  printf style templates used by formatBuffer_P() and is sent to the client each time the chunk buffer fills.
+ *  Memory use is the RESPONSE_CHUNK_SIZE buffer regardless of page size. For example:
+ *
+ *    ResponseWriter w(c);
+ *    w.begin(200,TEXT_HTML);
+ *    w.printf_P(html_header);
+ *    w.printf_P(html_title,"Nearby Devices");
+ *    for( int i=0; i<count; i++ ) w.printf_P(app_button,urls[i],names[i]);
+ *    w.printf_P(html_tail);
+ *    w.end();
+ *
+ *  A formatted fragment larger than the chunk buffer is streamed one conversion at a time, so neither the page
+ *  nor any single fragment is limited by buffer size. Unformatted content is sent with write() and write_P(), and
+ *  writeURLEncoded() URL encodes content directly into the chunk buffer, for links built from request data.
+ */
+
+#ifndef RESPONSE_WRITER_H
+#define RESPONSE_WRITER_H
+
+#include "WebContext.h"
+
+/** Leelanau Software Company namespace 
+*  
+*/
+namespace lsc {
+
+#ifndef RESPONSE_CHUNK_SIZE
+#define RESPONSE_CHUNK_SIZE 512
+#endif
+
+class ResponseWriter {
+
+  public:
+  ResponseWriter(WebContext* ctx)                     {_ctx = ctx;}
+  ~ResponseWriter()                                   {end();}
+
+/**
+ *   Send response headers. The body is sent with chunked encoding unless its exact length is given, see HtmlPage.
+ */
+  void     begin(int statusCode, PGM_P contentType, size_t contentLength=CONTENT_LENGTH_UNKNOWN);
+  int      printf_P(PGM_P format, ...);
+  int      printf(const char* format, ...);
+  int      vprintf_P(PGM_P format, va_list args);
+  int      vprintf(const char* format, va_list args);
+  size_t   write(const char* content, size_t len);
+  size_t   write(const char* content)                 {return ((content != NULL)?(write(content,strlen(content))):(0));}
+  size_t   write_P(PGM_P content, size_t len);
+  size_t   write_P(PGM_P content)                     {return ((content != NULL)?(write_P(content,strlen_P(content))):(0));}
+  size_t   writeURLEncoded(const char* content, size_t len);
+  size_t   writeURLEncoded(const char* content)       {return ((content != NULL)?(writeURLEncoded(content,strlen(content))):(0));}
+  void     flush();
+  void     end();
+
+  size_t   bytesWritten()                             {return _written + _pos;}
+  bool     truncated()                                {return _truncated;}
+
+  private:
+  int      append(bool progmem, const char* format, va_list args);
+  int      stream(bool progmem, const char* format, va_list args);
+
+  WebContext*   _ctx       = NULL;
+  char          _buffer[RESPONSE_CHUNK_SIZE];
+  size_t        _pos       = 0;
+  size_t        _written   = 0;
+  bool          _started   = false;
+  bool          _chunked   = false;
+  bool          _truncated = false;
+
+  ResponseWriter() {}
+  ResponseWriter(const ResponseWriter&) = delete;
+  ResponseWriter& operator=(const ResponseWriter&) = delete;
+};
+
+} // End of namespace lsc
+
+#endif
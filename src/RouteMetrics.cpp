@@ -0,0 +1,74 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "RouteMetrics.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+LatencyHistogram::LatencyHistogram() {
+  for( int i=0; i<METRIC_BUCKETS; i++ ) _buckets[i] = 0;
+  _count = 0;
+  _sum   = 0;
+}
+
+/**
+ *  Bucket i counts samples in (bound(i-1),bound(i)], found from the highest set bit of (us-1) >> METRIC_MIN_SHIFT.
+ *  Samples above the last bound are counted only in count(), the +Inf bucket.
+ */
+void LatencyHistogram::record(uint32_t us) {
+  uint32_t v = ((us > 0)?(us-1):(0)) >> METRIC_MIN_SHIFT;
+  int      i = ((v == 0)?(0):(32 - __builtin_clz(v)));
+  if( i < METRIC_BUCKETS ) METRIC_ADD(_buckets[i],1);
+  METRIC_ADD(_count,1);
+  METRIC_ADD(_sum,us);
+}
+
+static const int   codes[METRIC_CODES]   = {200,304,400,404,413,500,503};
+static const char* labels[METRIC_STATUS] = {"200","304","400","404","413","500","503","none","1xx","2xx","3xx","4xx","5xx"};
+
+RouteMetrics::RouteMetrics() {
+  for( int i=0; i<METRIC_STATUS; i++ ) _status[i] = 0;
+  _bytes = 0;
+}
+
+const char* RouteMetrics::status(int i) {return (((i >= 0) && (i < METRIC_STATUS))?(labels[i]):(""));}
+
+/**
+ *  The slot of a code counted on its own, else the slot after them for its class
+ */
+void RouteMetrics::record(int status, size_t bytes, uint32_t latencyUs, uint32_t firstByteUs) {
+  int slot = 0;
+  while( (slot < METRIC_CODES) && (codes[slot] != status) ) slot++;
+  if( slot == METRIC_CODES ) {
+    int statusClass = status/100;
+    slot += (((statusClass >= 1) && (statusClass <= 5))?(statusClass):(0));
+  }
+  METRIC_ADD(_status[slot],1);
+  METRIC_ADD(_bytes,bytes);
+  latency.record(latencyUs);
+  if( status != 0 ) firstByte.record(firstByteUs);
+}
+
+} // End of namespace lsc
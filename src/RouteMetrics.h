@@ -0,0 +1,105 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** Fixed size request counters kept by WebContext for each route once metrics are enabled: requests by status code,
+ *  content bytes sent, and histograms of handler latency and of time to first byte. Histogram buckets are powers of
+ *  2 microseconds from 64 us to about 2 s, so recording a sample costs a shift, a count leading zeros and a few
+ *  relaxed atomic adds, with no heap and no floating point. WebContext renders them in Prometheus text format at its
+ *  metrics route, see WebContext::enableMetrics().
+ */
+
+#ifndef ROUTE_METRICS_H
+#define ROUTE_METRICS_H
+
+#include "CommonProgmem.h"
+
+#if defined(LSC_HOST) || defined(ESP32)
+#include <atomic>
+typedef std::atomic<uint32_t>   MetricCounter;
+typedef std::atomic<uint64_t>   MetricTotal;
+#define METRIC_ADD(c,n)         (c).fetch_add((n),std::memory_order_relaxed)
+#define METRIC_GET(c)           (c).load(std::memory_order_relaxed)
+#else
+typedef uint32_t                MetricCounter;
+typedef uint64_t                MetricTotal;
+#define METRIC_ADD(c,n)         ((c) += (n))
+#define METRIC_GET(c)           (c)
+#endif
+
+#define METRIC_BUCKETS          16               // Histogram buckets, before +Inf
+#define METRIC_MIN_SHIFT        6                // First bucket bound is 2^6 us
+#define METRIC_CODES            7                // Status codes the server sends, counted on their own
+#define METRIC_STATUS           (METRIC_CODES+6) // Those codes, then no response and each class for other codes
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+class LatencyHistogram {
+  public:
+  LatencyHistogram();
+
+  void          record(uint32_t us);
+  uint32_t      bucket(int i) const                              {return METRIC_GET(_buckets[i]);}
+  uint32_t      count() const                                    {return METRIC_GET(_count);}
+  uint64_t      sum() const                                      {return METRIC_GET(_sum);}
+
+/**
+ *  Upper bound of bucket i in us, inclusive
+ */
+  static uint32_t bound(int i)                                   {return ((uint32_t)1) << (METRIC_MIN_SHIFT+i);}
+
+  private:
+  MetricCounter _buckets[METRIC_BUCKETS];
+  MetricCounter _count;
+  MetricTotal   _sum;
+};
+
+class RouteMetrics {
+  public:
+  RouteMetrics();
+
+/**
+ *  Record one request, with latency and first byte times in us
+ */
+  void          record(int status, size_t bytes, uint32_t latency, uint32_t firstByte);
+
+/**
+ *  Requests counted in status slot i, below METRIC_STATUS, and its code as a label: "200" through "503" for the
+ *  codes counted on their own, "none" when the handler sent nothing, and "1xx" through "5xx" for any other code
+ */
+  uint32_t      requests(int i) const                            {return METRIC_GET(_status[i]);}
+  static const char* status(int i);
+  uint64_t      bytes() const                                    {return METRIC_GET(_bytes);}
+
+  LatencyHistogram latency;
+  LatencyHistogram firstByte;
+
+  private:
+  MetricCounter _status[METRIC_STATUS];
+  MetricTotal   _bytes;
+};
+
+} // End of namespace lsc
+
+#endif
@@ -0,0 +1,216 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+#include "RouteTable.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+/**
+ *   Grow a POD array to at least n elements, doubling capacity
+ */
+template<typename T>
+static T* grow(T* a, int count, int& capacity, int n) {
+  if( n <= capacity ) return a;
+  int cap = ((capacity > 0)?(capacity):(8));
+  while( cap < n ) cap *= 2;
+  T* result = new T[cap];
+  if( a != NULL ) {memcpy(result,a,count*sizeof(T)); delete [] a;}
+  capacity = cap;
+  return result;
+}
+
+RouteTable::RouteTable() {
+  addNode(-1,"",0,0);
+}
+
+RouteTable::~RouteTable() {
+  for( int i=0; i<_routeCount; i++ ) delete [] _routes[i].pattern;
+  delete [] _routes;
+  delete [] _nodes;
+  delete [] _slots;
+}
+
+/**
+ *   Split path into non empty segments, hashing each. Returns the number of segments, or -1 if there are more than
+ *   ROUTE_MAX_SEGMENTS.
+ */
+int RouteTable::split(const char* path, URNToken segments[], uint32_t hashes[]) const {
+  int count = 0;
+  URNTokenIterator it(path,'/');
+  for( unsigned i=0; i<it.size(); i++ ) {
+    URNToken t = it[i];
+    if( t.length() > 0 ) {
+      if( count == ROUTE_MAX_SEGMENTS ) return -1;
+      hashes[count]     = fnv1a(t.ptr(),t.length());
+      segments[count++] = t;
+    }
+  }
+  return count;
+}
+
+int RouteTable::find(int parent, const char* segment, size_t len, uint32_t hash) const {
+  for( unsigned s = slot(parent,hash); _slots[s] >= 0; s = (s+1) & (_slotCount-1) ) {
+    const Node& n = _nodes[_slots[s]];
+    if( (n.hash == hash) && (n.parent == parent) && (n.len == len) && (memcmp(n.segment,segment,len) == 0) ) return _slots[s];
+  }
+  return -1;
+}
+
+/**
+ *   Literal nodes are indexed in the hash table, {param} nodes are reached only through their parent
+ */
+void RouteTable::index(int node) {
+  unsigned s = slot(_nodes[node].parent,_nodes[node].hash);
+  while( _slots[s] >= 0 ) s = (s+1) & (_slotCount-1);
+  _slots[s] = node;
+}
+
+int RouteTable::addNode(int parent, const char* segment, size_t len, uint32_t hash) {
+  if( (_nodeCount == INT16_MAX) || (len > UINT16_MAX) ) return -1;
+  _nodes = grow(_nodes,_nodeCount,_nodeCapacity,_nodeCount+1);
+  int result = _nodeCount++;
+  Node& n  = _nodes[result];
+  n.segment = segment;
+  n.hash    = hash;
+  n.len     = len;
+  n.parent  = parent;
+  n.param   = -1;
+  n.route   = -1;
+
+/**
+ *  Keep the hash table at most half full, rebuilding it when it grows
+ */
+  if( 2*(unsigned)_nodeCount > _slotCount ) {
+    delete [] _slots;
+    _slotCount = ((_slotCount > 0)?(2*_slotCount):(16));
+    _slots     = new int16_t[_slotCount];
+    memset(_slots,0xFF,_slotCount*sizeof(int16_t));
+    for( int i=1; i<_nodeCount; i++ ) {if( _nodes[i].len > 0 ) index(i);}
+  }
+  return result;
+}
+
+int RouteTable::add(const char* pattern) {
+  if( pattern == NULL ) return -1;
+
+/**
+ *  The pattern is kept twice: as given, and as a working copy holding segment text and '\0' terminated param names
+ */
+  size_t len  = strlen(pattern);
+  char*  copy = new char[2*(len+1)];
+  memcpy(copy,pattern,len+1);
+  memcpy(copy+len+1,pattern,len+1);
+  char*  work = copy+len+1;
+
+  URNToken segments[ROUTE_MAX_SEGMENTS];
+  uint32_t hashes[ROUTE_MAX_SEGMENTS];
+  int      count  = split(work,segments,hashes);
+  int      params = 0;
+  for( int i=0; i<count; i++ ) {if( isParam(segments[i]) ) params++;}
+  if( (count < 0) || (params > ROUTE_MAX_PARAMS) ) {delete [] copy; return -1;}
+
+/**
+ *  Nodes reference segment text in the working copy, so once a node is added the copy is kept even if the route
+ *  itself cannot be
+ */
+  Route r;
+  r.pattern    = copy;
+  r.paramCount = 0;
+  int  node    = 0;
+  bool added   = false;
+  for( int i=0; (i<count) && (node >= 0); i++ ) {
+    char*  seg = (char*)segments[i].ptr();
+    size_t n   = segments[i].length();
+    if( isParam(segments[i]) ) {
+      seg[n-1] = '\0';
+      r.names[r.paramCount++] = seg+1;
+      if( _nodes[node].param < 0 ) {int p = addNode(node,"",0,0); if( p >= 0 ) {_nodes[node].param = p; added = true;} node = p;}
+      else node = _nodes[node].param;
+    }
+    else {
+      int child = find(node,seg,n,hashes[i]);
+      if( child < 0 ) {child = addNode(node,seg,n,hashes[i]); if( child >= 0 ) {index(child); added = true;}}
+      node = child;
+    }
+  }
+
+  int result = -1;
+  if( (node >= 0) && (_nodes[node].route >= 0) ) result = _nodes[node].route;
+  else if( node >= 0 ) {
+    _routes = grow(_routes,_routeCount,_routeCapacity,_routeCount+1);
+    result  = _routeCount++;
+    _routes[result]    = r;
+    _nodes[node].route = result;
+    copy    = NULL;
+  }
+  if( (copy != NULL) && !added ) delete [] copy;
+  return result;
+}
+
+int RouteTable::match(int node, const URNToken segments[], const uint32_t hashes[], int count, int i, int p, URNToken values[]) const {
+  if( i == count ) return _nodes[node].route;
+  int result = -1;
+  int child  = find(node,segments[i].ptr(),segments[i].length(),hashes[i]);
+  if( child >= 0 ) result = match(child,segments,hashes,count,i+1,p,values);
+  if( (result < 0) && (_nodes[node].param >= 0) && (p < ROUTE_MAX_PARAMS) ) {
+    values[p] = segments[i];
+    result = match(_nodes[node].param,segments,hashes,count,i+1,p+1,values);
+  }
+  return result;
+}
+
+int RouteTable::match(const char* path, RouteParams& params) const {
+  URNToken segments[ROUTE_MAX_SEGMENTS];
+  uint32_t hashes[ROUTE_MAX_SEGMENTS];
+  params._count = 0;
+  int count  = split(path,segments,hashes);
+  int result = ((count >= 0)?(match(0,segments,hashes,count,0,0,params._values)):(-1));
+  if( result >= 0 ) {
+    const Route& r = _routes[result];
+    params._count  = r.paramCount;
+    for( int i=0; i<r.paramCount; i++ ) params._names[i] = r.names[i];
+  }
+  return result;
+}
+
+void RouteArgs::set(const RouteParams& params) {
+  size_t pos = 0;
+  for( int i=0; i<params.count(); i++ ) {
+    char* value = _buffer + pos;
+    params.value(i).getToken(value,sizeof(_buffer)-pos);
+    pos += strlen(value);
+    if( pos < sizeof(_buffer)-1 ) pos++;
+    _values[i] = value;
+    _names[i]  = params.name(i);
+  }
+  _count = params.count();
+}
+
+const char* RouteArgs::value(const char* name) const {
+  for( int i=0; i<_count; i++ ) {if( strcmp(_names[i],name) == 0 ) return _values[i];}
+  return NULL;
+}
+
+} // End of namespace lsc
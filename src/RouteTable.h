@@ -0,0 +1,158 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** RouteTable maps request paths to route ids. Paths are split into segments on '/' with URNTokenIterator and
+ *  stored as a trie, where the children of every node are found through a single hash table keyed on the parent
+ *  node and the FNV-1a hash of the segment. Matching a path costs one hash probe per segment, regardless of the
+ *  number of routes registered.
+ *
+ *  A segment of the form {name} matches any single segment and captures it as a path argument. Literal segments
+ *  are preferred over captures, falling back to the capture if the rest of the path does not match. For example,
+ *  with routes
+ *     /{device}/nearbyDevices   id 0
+ *     /styles.css               id 1
+ *  the path /RelayControl/nearbyDevices matches route 0 with device = "RelayControl".
+ *
+ *  Empty segments are ignored, so /a//b/ matches /a/b, and / matches the root route. Segment text is copied, so
+ *  patterns need not be string literals.
+ */
+
+#ifndef ROUTE_TABLE_H
+#define ROUTE_TABLE_H
+
+#include "CommonProgmem.h"
+
+#ifndef ROUTE_MAX_SEGMENTS
+#define ROUTE_MAX_SEGMENTS   16
+#endif
+#ifndef ROUTE_MAX_PARAMS
+#define ROUTE_MAX_PARAMS     4
+#endif
+#ifndef ROUTE_ARGS_SIZE
+#define ROUTE_ARGS_SIZE      128
+#endif
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+/**
+ *   Path arguments captured by RouteTable::match(). Values point into the matched path and are not '\0' terminated.
+ */
+class RouteParams {
+  public:
+  RouteParams() {}
+
+  int               count() const                                { return _count;}
+  const char*       name(int i) const                            { return (((i >= 0) && (i < _count))?(_names[i]):(NULL));}
+  const URNToken&   value(int i) const                           { return _values[(((i >= 0) && (i < _count))?(i):(ROUTE_MAX_PARAMS))];}
+
+  private:
+  int               _count = 0;
+  const char*       _names[ROUTE_MAX_PARAMS];
+  URNToken          _values[ROUTE_MAX_PARAMS+1];
+
+  friend class RouteTable;
+};
+
+/**
+ *   '\0' terminated copies of the path arguments of a match, held for the duration of a handler. Values longer than
+ *   the ROUTE_ARGS_SIZE buffer are truncated, and value(name) returns NULL if there is no such param.
+ */
+class RouteArgs {
+  public:
+  RouteArgs() {}
+
+  void              set(const RouteParams& params);
+  void              clear()                                      { _count = 0;}
+  int               count() const                                { return _count;}
+  const char*       value(int i) const                           { return (((i >= 0) && (i < _count))?(_values[i]):(NULL));}
+  const char*       name(int i) const                            { return (((i >= 0) && (i < _count))?(_names[i]):(NULL));}
+  const char*       value(const char* name) const;
+
+  private:
+  int               _count = 0;
+  const char*       _names[ROUTE_MAX_PARAMS];
+  const char*       _values[ROUTE_MAX_PARAMS];
+  char              _buffer[ROUTE_ARGS_SIZE];
+};
+
+class RouteTable {
+  public:
+  RouteTable();
+  ~RouteTable();
+  RouteTable(const RouteTable&) = delete;
+  RouteTable& operator=(const RouteTable&) = delete;
+
+/**
+ *   Add pattern, returning its route id. Ids are assigned in order from 0, and adding a pattern already present
+ *   returns the existing id, keeping the original param names. Returns -1 if the pattern has more than
+ *   ROUTE_MAX_SEGMENTS segments or ROUTE_MAX_PARAMS captures.
+ */
+  int         add(const char* pattern);
+
+/**
+ *   Match path, returning the route id and setting params, or -1 if no route matches
+ */
+  int         match(const char* path, RouteParams& params) const;
+
+  int         size() const                                       { return _routeCount;}
+  const char* pattern(int route) const                           { return (((route >= 0) && (route < _routeCount))?(_routes[route].pattern):(NULL));}
+
+  private:
+  struct Node {
+    const char*    segment;
+    uint32_t       hash;
+    uint16_t       len;
+    int16_t        parent;
+    int16_t        param;                // Child node for a {param} segment, -1 if none
+    int16_t        route;                // Route ending at this node, -1 if none
+  };
+
+  struct Route {
+    char*          pattern;
+    const char*    names[ROUTE_MAX_PARAMS];
+    uint8_t        paramCount;
+  };
+
+  static bool isParam(const URNToken& t)                         { return (t.length() > 2) && (t.ptr()[0] == '{') && (t.ptr()[t.length()-1] == '}');}
+  int         split(const char* path, URNToken segments[], uint32_t hashes[]) const;
+  int         find(int parent, const char* segment, size_t len, uint32_t hash) const;
+  int         addNode(int parent, const char* segment, size_t len, uint32_t hash);
+  void        index(int node);
+  int         match(int node, const URNToken segments[], const uint32_t hashes[], int count, int i, int p, URNToken values[]) const;
+  unsigned    slot(int parent, uint32_t hash) const              { return (hash ^ ((uint32_t)parent * 0x9E3779B1)) & (_slotCount-1);}
+
+  Node*       _nodes        = NULL;
+  int         _nodeCount    = 0;
+  int         _nodeCapacity = 0;
+  int16_t*    _slots        = NULL;
+  unsigned    _slotCount    = 0;
+  Route*      _routes       = NULL;
+  int         _routeCount   = 0;
+  int         _routeCapacity = 0;
+};
+
+} // End of namespace lsc
+
+#endif
@@ -0,0 +1,229 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** StaticWebContext is an alternative to WebContext where the server is a template parameter rather than a set of
+ *  std::function hooks. Calls such as send(), arg() and argName() are inline forwards to the server, with no
+ *  indirect call and no lambda captures held per hook, and arg() returns the server's String by reference where
+ *  the server does (ESP8266WebServer, HostServer). WebContext remains the class to use where the server is chosen
+ *  at run time or injected with setters, and is what ResponseWriter and the libraries built on CommonUtil accept.
+ *
+ *  Routes are dispatched through a RouteTable exactly as by WebContext, with {param} captures available from
+ *  pathArg(). Handlers receive the StaticWebContext:
+ *
+ *    DirectWebContext ctx;
+ *    ctx.begin(80);
+ *    ctx.on("/{device}/state",[](DirectWebContext* c){c->send(200,"text/plain",c->pathArg("device"));});
+ *
+ *  DirectWebContext is StaticWebContext over the platform server: ESP8266WebServer, WebServer (ESP32) or HostServer.
+ */
+
+#ifndef STATIC_WEB_CONTEXT_H
+#define STATIC_WEB_CONTEXT_H
+
+#include <utility>
+#include "WebContext.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+template<class Server>
+class StaticWebContext {
+
+  public:
+  typedef std::function<void(StaticWebContext*)> Handler;
+
+  StaticWebContext() {}
+  ~StaticWebContext()                                                                 {delete [] _handlers;}
+
+  void       begin(int port=80)                                                       {_server.begin(port); _port = localPort(_server,port); _server.onNotFound([this](){dispatch();});}
+  void       handleClient()                                                           {_server.handleClient();}
+  void       close()                                                                  {_server.close();}
+  int        getLocalPort()                                                           {return _port;}
+
+  void       send(int statusCode, const char* contentType, const char* content)       {_server.send(statusCode,contentType,content);}
+  void       send_P(int statusCode, PGM_P contentType, PGM_P content)                 {_server.send_P(statusCode,contentType,content);}
+  void       send_P(int statusCode, const ProgmemAsset& asset);
+  void       setContentLength(size_t len)                                             {_server.setContentLength(len);}
+  void       sendContent(const char* content, size_t len)                             {_server.sendContent(content,len);}
+  void       sendHeader(const char* name, const char* value)                          {_server.sendHeader(name,value);}
+  void       addHandler(RequestHandler* h)                                            {_server.addHandler(h);}
+
+  int        argCount()                                                               {return _server.args();}
+  auto       arg(int i) -> decltype(std::declval<Server&>().arg(i))                   {return _server.arg(i);}
+  auto       argName(int i) -> decltype(std::declval<Server&>().argName(i))           {return _server.argName(i);}
+  auto       uri() -> decltype(std::declval<Server&>().uri())                         {return _server.uri();}
+  auto       client() -> decltype(std::declval<Server&>().client())                   {return _server.client();}
+  auto       header(const char* name) -> decltype(std::declval<Server&>().header(name)) {return _server.header(name);}
+  void       collectHeader(const char* name);
+
+  void       on(const char* path, Handler f);
+  void       onNotFound(Handler f)                                                    {_notFoundHandler = f;}
+  void       serveStatic_P(const char* path, PGM_P contentType, PGM_P content, unsigned long maxAge=WEB_CACHE_MAX_AGE);
+  void       serveStatic_P(const char* path, const ProgmemAsset& asset, unsigned long maxAge=WEB_CACHE_MAX_AGE);
+
+  int        pathArgCount() const                                                     {return ((_pathArgs != NULL)?(_pathArgs->count()):(0));}
+  const char* pathArg(int i) const                                                    {return ((_pathArgs != NULL)?(_pathArgs->value(i)):(NULL));}
+  const char* pathArgName(int i) const                                                {return ((_pathArgs != NULL)?(_pathArgs->name(i)):(NULL));}
+  const char* pathArg(const char* name) const                                         {return ((_pathArgs != NULL)?(_pathArgs->value(name)):(NULL));}
+
+  void       dispatch();
+
+#ifdef LSC_HOST
+  int        inject(const char* request, String& response)                           {return _server.inject(request,response);}
+#endif
+
+  Server&    server()                                                                 {return _server;}
+
+  private:
+#ifdef LSC_HOST
+  static int localPort(HostServer& s, int)                                            {return s.port();}
+#endif
+  template<class S>
+  static int localPort(S&, int port)                                                  {return port;}
+
+  Server                _server;
+  int                   _port = 0;
+  RouteTable            _routes;
+  Handler*              _handlers = NULL;
+  int                   _handlerCapacity = 0;
+  Handler               _notFoundHandler = NULL;
+  static WEB_THREAD_LOCAL RouteArgs* _pathArgs;      // Path args of the dispatch running on this thread
+  const char*           _headerKeys[WEB_MAX_HEADERS];
+  size_t                _headerCount = 0;
+};
+
+template<class Server>
+WEB_THREAD_LOCAL RouteArgs* StaticWebContext<Server>::_pathArgs = NULL;
+
+template<class Server>
+void StaticWebContext<Server>::collectHeader(const char* name) {
+  for( size_t i=0; i<_headerCount; i++ ) {if( strcasecmp(_headerKeys[i],name) == 0 ) return;}
+  if( _headerCount < WEB_MAX_HEADERS ) {
+    _headerKeys[_headerCount++] = name;
+    _server.collectHeaders(_headerKeys,_headerCount);
+  }
+}
+
+template<class Server>
+void StaticWebContext<Server>::on(const char* path, Handler f) {
+  int route = _routes.add(path);
+  if( route >= _handlerCapacity ) {
+    int cap = ((_handlerCapacity > 0)?(2*_handlerCapacity):(8));
+    while( cap <= route ) cap *= 2;
+    Handler* handlers = new Handler[cap];
+    for( int i=0; i<_handlerCapacity; i++ ) handlers[i] = std::move(_handlers[i]);
+    delete [] _handlers;
+    _handlers        = handlers;
+    _handlerCapacity = cap;
+  }
+  if( route >= 0 ) _handlers[route] = f;
+}
+
+template<class Server>
+void StaticWebContext<Server>::dispatch() {
+  RouteParams   params;
+  const String& path  = _server.uri();
+  int           route = _routes.match(path.c_str(),params);
+  if( (route >= 0) && (_handlers[route] != NULL) ) {
+    RouteArgs  args;
+    RouteArgs* previous = _pathArgs;
+    args.set(params);
+    _pathArgs = &args;
+    _handlers[route](this);
+    _pathArgs = previous;
+  }
+  else if( _notFoundHandler != NULL ) _notFoundHandler(this);
+  else _server.send(404,"text/plain","Not Found");
+}
+
+template<class Server>
+void StaticWebContext<Server>::serveStatic_P(const char* path, PGM_P contentType, PGM_P content, unsigned long maxAge) {
+  collectHeader("If-None-Match");
+  size_t len = strlen_P(content);
+  char   etag[32];
+  char   cacheControl[24];
+  snprintf(etag,sizeof(etag),"\"%08lx-%lx\"",(unsigned long)fnv1a_P(content,len),(unsigned long)len);
+  snprintf(cacheControl,sizeof(cacheControl),"max-age=%lu",maxAge);
+  String tag(etag);
+  String cc(cacheControl);
+  on(path,[tag,cc,contentType,content](StaticWebContext* c) {
+    c->sendHeader("ETag",tag.c_str());
+    c->sendHeader("Cache-Control",cc.c_str());
+    const String& match = c->header("If-None-Match");
+    if( (match == "*") || (strstr(match.c_str(),tag.c_str()) != NULL) ) c->send_P(304,contentType,"");
+    else                                                                 c->send_P(200,contentType,content);
+  });
+}
+
+/**
+ *   As WebContext::send_P() for a ProgmemAsset, with the server's length bounded send_P() for binary gzip content
+ */
+template<class Server>
+void StaticWebContext<Server>::send_P(int statusCode, const ProgmemAsset& asset) {
+  bool gzip = (asset.gzip != NULL) && (strstr(header("Accept-Encoding").c_str(),"gzip") != NULL);
+  if( asset.gzip != NULL ) sendHeader("Vary","Accept-Encoding");
+  if( gzip )               sendHeader("Content-Encoding","gzip");
+  if( gzip ) _server.send_P(statusCode,asset.contentType,asset.gzip,asset.gzipLength);
+  else       _server.send_P(statusCode,asset.contentType,asset.content,asset.length);
+}
+
+template<class Server>
+void StaticWebContext<Server>::serveStatic_P(const char* path, const ProgmemAsset& asset, unsigned long maxAge) {
+  collectHeader("If-None-Match");
+  collectHeader("Accept-Encoding");
+  char   etag[32];
+  char   gzipEtag[36];
+  char   cacheControl[24];
+  snprintf(etag,sizeof(etag),"\"%08lx-%lx\"",(unsigned long)asset.hash,(unsigned long)asset.length);
+  snprintf(gzipEtag,sizeof(gzipEtag),"\"%08lx-%lx-gz\"",(unsigned long)asset.hash,(unsigned long)asset.length);
+  snprintf(cacheControl,sizeof(cacheControl),"max-age=%lu",maxAge);
+  String tag(etag);
+  String gzipTag(gzipEtag);
+  String cc(cacheControl);
+  ProgmemAsset a = asset;
+  on(path,[tag,gzipTag,cc,a](StaticWebContext* c) {
+    bool          gzip  = (a.gzip != NULL) && (strstr(c->header("Accept-Encoding").c_str(),"gzip") != NULL);
+    const String& etag  = ((gzip)?(gzipTag):(tag));
+    c->sendHeader("ETag",etag.c_str());
+    c->sendHeader("Cache-Control",cc.c_str());
+    const String& match = c->header("If-None-Match");
+    if( (match == "*") || (strstr(match.c_str(),etag.c_str()) != NULL) ) {
+      if( a.gzip != NULL ) c->sendHeader("Vary","Accept-Encoding");
+      c->send_P(304,a.contentType,"");
+    }
+    else c->send_P(200,a);
+  });
+}
+
+#ifdef ESP8266
+typedef StaticWebContext<ESP8266WebServer>  DirectWebContext;
+#elif defined(ESP32)
+typedef StaticWebContext<WebServer>         DirectWebContext;
+#elif defined(LSC_HOST)
+typedef StaticWebContext<HostServer>        DirectWebContext;
+#endif
+
+} // End of namespace lsc
+
+#endif
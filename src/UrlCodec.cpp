@@ -0,0 +1,199 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+
+#include "UrlCodec.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+/**
+ *  Bit c of unreserved is set for the URL unreserved characters A-Z a-z 0-9 - . _ ~
+ */
+static const uint8_t unreserved[16] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0xFF, 0x03, 0xFE, 0xFF, 0xFF, 0x87, 0xFE, 0xFF, 0xFF, 0x47};
+static const char    hexDigits[]    = "0123456789ABCDEF";
+static const char    b64Alphabet[]  = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+static const int8_t  b64Values[128] = {
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+  -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+  52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+  -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+  15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+  -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+  41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1
+};
+
+typedef uintptr_t word_t;
+static const word_t ones  = ((word_t)-1)/0xFF;
+static const word_t highs = ones << 7;
+
+static inline bool isUnreserved(uint8_t c)  {return (c < 128) && ((unreserved[c >> 3] & (1 << (c & 7))) != 0);}
+static inline int  hexValue(char c)         {return (((c >= '0') && (c <= '9'))?(c-'0'):((((c|0x20) >= 'a') && ((c|0x20) <= 'f'))?((c|0x20)-'a'+10):(-1)));}
+
+/**
+ *   High bit of each byte of w set if the byte is in [lo,hi], for w with the high bit of every byte clear, since
+ *   then neither sum can carry into the next byte
+ */
+static inline word_t inRange(word_t w, uint8_t lo, uint8_t hi) {
+  return (w + ones*(0x80-lo)) & ~(w + ones*(0x7F-hi)) & highs;
+}
+
+/**
+ *   High bit of each byte set if the byte at p+i is unreserved, for sizeof(word_t) bytes at p, which need not be
+ *   aligned. Bytes from 0x80 are tested on their low 7 bits and then excluded.
+ */
+static inline word_t unreservedWord(const char* p) {
+  word_t w;
+  memcpy(&w,p,sizeof(w));
+  word_t a = w & ~highs;
+  return (inRange(a,'-','.') | inRange(a,'0','9') | inRange(a,'A','Z') | inRange(a,'_','_') | inRange(a,'a','z') | inRange(a,'~','~')) & ~w;
+}
+
+/**
+ *   Each escaped byte adds 2 to the length, so whole words are counted with a popcount of their reserved bytes
+ */
+size_t urlEncodedLength(const char* str, size_t len) {
+  size_t result = len;
+  size_t i = 0;
+  for( ; i+sizeof(word_t) <= len; i += sizeof(word_t) ) result += 2*__builtin_popcountll(~unreservedWord(str+i) & highs);
+  for( ; i<len; i++ ) {if( !isUnreserved(str[i]) ) result += 2;}
+  return result;
+}
+
+/**
+ *   Whole words of plain text are copied in one step, and only words holding a reserved byte go through the table
+ */
+size_t urlEncodeChunk(char dst[], size_t dstLen, const char* src, size_t len, size_t& consumed) {
+  size_t i = 0;
+  size_t j = 0;
+  while( i < len ) {
+    size_t n = (((len-i) < sizeof(word_t))?(len-i):(sizeof(word_t)));
+    if( (n == sizeof(word_t)) && (dstLen-j >= n) && (unreservedWord(src+i) == highs) ) {
+      memcpy(dst+j,src+i,n);
+      i += n;
+      j += n;
+      continue;
+    }
+    for( size_t end=i+n; i<end; i++ ) {
+      uint8_t c = src[i];
+      if( isUnreserved(c) ) {
+        if( j == dstLen ) {consumed = i; return j;}
+        dst[j++] = c;
+      }
+      else {
+        if( dstLen-j < 3 ) {consumed = i; return j;}
+        dst[j++] = '%';
+        dst[j++] = hexDigits[c >> 4];
+        dst[j++] = hexDigits[c & 0x0F];
+      }
+    }
+  }
+  consumed = i;
+  return j;
+}
+
+int urlEncode(char buffer[], int size, int pos, const char* str, size_t len) {
+  int result = size;
+  if( (pos >= 0) && (pos < size-1) ) {
+    size_t consumed = 0;
+    result = pos + urlEncodeChunk(buffer+pos,size-1-pos,str,len,consumed);
+    buffer[result] = '\0';
+  }
+  return result;
+}
+
+size_t urlDecode(char* str, bool plusIsSpace) {
+  char*       out = str;
+  const char* in  = str;
+  for( char c = *in++; c != '\0'; c = *in++ ) {
+    if( c == '%' ) {
+      int h = hexValue(in[0]);
+      int l = ((h >= 0)?(hexValue(in[1])):(-1));
+      if( l >= 0 ) {c = (char)((h << 4) | l); in += 2;}
+    }
+    else if( (c == '+') && plusIsSpace ) c = ' ';
+    *out++ = c;
+  }
+  *out = '\0';
+  return out - str;
+}
+
+int base64Encode(char buffer[], int size, int pos, const uint8_t* data, size_t len) {
+  int result = size;
+  if( (pos >= 0) && (pos < size-1) ) {
+    char*  out   = buffer+pos;
+    size_t avail = size-1-pos;
+    size_t i     = 0;
+    for( ; (i+3 <= len) && (avail >= 4); i+=3, avail-=4 ) {
+      uint32_t v = ((uint32_t)data[i] << 16) | ((uint32_t)data[i+1] << 8) | data[i+2];
+      *out++ = b64Alphabet[(v >> 18) & 0x3F];
+      *out++ = b64Alphabet[(v >> 12) & 0x3F];
+      *out++ = b64Alphabet[(v >> 6) & 0x3F];
+      *out++ = b64Alphabet[v & 0x3F];
+    }
+    if( (i < len) && (len-i < 3) && (avail >= 4) ) {
+      uint32_t v = ((uint32_t)data[i] << 16) | ((i+1 < len)?((uint32_t)data[i+1] << 8):(0));
+      *out++ = b64Alphabet[(v >> 18) & 0x3F];
+      *out++ = b64Alphabet[(v >> 12) & 0x3F];
+      *out++ = ((i+1 < len)?(b64Alphabet[(v >> 6) & 0x3F]):('='));
+      *out++ = '=';
+    }
+    *out   = '\0';
+    result = out - buffer;
+  }
+  return result;
+}
+
+size_t base64DecodedLength(const char* b64, size_t len) {
+  size_t n = len;
+  if( (n > 0) && (b64[n-1] == '=') ) n--;
+  if( (n > 0) && (b64[n-1] == '=') ) n--;
+  if( ((n < len) && ((len % 4) != 0)) || ((n % 4) == 1) ) return 0;
+  return (n*3)/4;
+}
+
+int base64Decode(uint8_t buffer[], size_t size, const char* b64, size_t len) {
+  size_t result = base64DecodedLength(b64,len);
+  if( ((result == 0) && (len > 0)) || (result > size) ) return -1;
+  size_t   n    = (4*result + 2)/3;                     // Characters before padding
+  uint32_t acc  = 0;
+  int      bits = 0;
+  size_t   j    = 0;
+  for( size_t i=0; i<n; i++ ) {
+    uint8_t c = b64[i];
+    int     v = ((c < 128)?(b64Values[c]):(-1));
+    if( v < 0 ) return -1;
+    acc   = (acc << 6) | v;
+    bits += 6;
+    if( bits >= 8 ) {
+      bits -= 8;
+      buffer[j++] = (uint8_t)(acc >> bits);
+      acc &= (1UL << bits) - 1;
+    }
+  }
+  return j;
+}
+
+} // End of namespace lsc
@@ -0,0 +1,92 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+/** URL percent encoding and base64 encoding, with exact output lengths computed up front. URL encoding leaves the
+ *  RFC 3986 unreserved characters (A-Z a-z 0-9 - . _ ~) as is and writes every other byte as %XX. Writers never
+ *  split a %XX escape or a base64 quad, so truncated output is still valid. For example, a signed URL:
+ *
+ *    char url[256];
+ *    int pos = formatBuffer(url,sizeof(url),0,"/config?sig=");
+ *    pos = urlEncode(url,sizeof(url),pos,signature);
+ *
+ *  ResponseWriter::writeURLEncoded() encodes straight into the chunk buffer of a streamed response.
+ */
+
+#ifndef URL_CODEC_H
+#define URL_CODEC_H
+
+#include "CommonProgmem.h"
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+/**
+ *  Encoded length of len bytes of str, not counting a '\0'
+ */
+extern size_t urlEncodedLength(const char* str, size_t len);
+
+/**
+ *  Encode len bytes of src into at most dstLen bytes of dst, without a '\0', stopping before an escape that does
+ *  not fit. Returns the bytes written and sets consumed to the bytes of src encoded.
+ */
+extern size_t urlEncodeChunk(char dst[], size_t dstLen, const char* src, size_t len, size_t& consumed);
+
+/**
+ *  Encode str into buffer starting at pos, formatBuffer() style. The buffer is '\0' terminated, truncated at a whole
+ *  escape if size is exceeded, and the updated position is returned.
+ */
+extern int    urlEncode(char buffer[], int size, int pos, const char* str, size_t len);
+inline int    urlEncode(char buffer[], int size, int pos, const char* str)   {return ((str != NULL)?(urlEncode(buffer,size,pos,str,strlen(str))):(pos));}
+
+/**
+ *  Decode '\0' terminated str in place, %XX to its byte and, when plusIsSpace is set as in query strings and form
+ *  bodies, '+' to ' '. Malformed escapes are kept as is. Returns the decoded length.
+ */
+extern size_t urlDecode(char* str, bool plusIsSpace=true);
+
+/**
+ *  Encoded length of len bytes as padded base64, not counting a '\0'
+ */
+inline size_t base64EncodedLength(size_t len)                                {return 4*((len+2)/3);}
+
+/**
+ *  Base64 encode len bytes of data into buffer starting at pos, '\0' terminated, with the same truncation and
+ *  return value as urlEncode()
+ */
+extern int    base64Encode(char buffer[], int size, int pos, const uint8_t* data, size_t len);
+
+/**
+ *  Decoded length of len characters of base64, padded or not, or 0 if len is not a valid base64 length
+ */
+extern size_t base64DecodedLength(const char* b64, size_t len);
+
+/**
+ *  Decode len characters of base64 into buffer. Returns the bytes decoded, or -1 if b64 is not valid base64 or
+ *  the decoded data does not fit in size bytes.
+ */
+extern int    base64Decode(uint8_t buffer[], size_t size, const char* b64, size_t len);
+
+} // End of namespace lsc
+
+#endif
@@ -25,6 +25,10 @@
  *  for a variety of Web Servers. 
  */
 #include "WebContext.h"
+#include "CommonProgmem.h"
+#include "UrlCodec.h"
+#include "ResponseWriter.h"
+#include "Logger.h"
 
 /** Leelanau Software Company namespace 
 *  
@@ -32,6 +36,709 @@
 namespace lsc {
 
 const String    WebContext::_empty("");
+WEB_THREAD_LOCAL RequestContext* WebContext::_request = NULL;
+
+/**
+ *  Decoder of an onUpload() route, with the request it is decoding. A body of another request arriving meanwhile is
+ *  held back until the owner's body has been taken, or its connection has gone.
+ */
+struct WebContext::RouteUpload {
+  RouteUpload(FieldFunction f) : decoder(f) {}
+  BodyDecoder        decoder;
+  const HttpParser*  owner = NULL;
+};
+
+WebContext::~WebContext() {
+  for( int i=0; i<_handlerCapacity; i++ ) delete _options[i].upload;
+  for( int i=0; i<_handlerCapacity; i++ ) delete _options[i].metrics;
+  delete _notFoundMetrics;
+  for( int i=0; i<_handlerCapacity; i++ ) delete _options[i].profile;
+  delete _notFoundProfile;
+  delete [] _handlers;
+  delete [] _options;
+  while( _channels != NULL ) {EventChannel* e = _channels; _channels = e->_next; delete e;}
+}
+
+/**
+ *  Add name to the request headers retained by the server. Names are not copied and should be string literals.
+ */
+void WebContext::collectHeader(const char* name) {
+  for( size_t i=0; i<_headerCount; i++ ) {if( strcasecmp(_headerKeys[i],name) == 0 ) return;}
+  if( _headerCount < WEB_MAX_HEADERS ) {
+    _headerKeys[_headerCount++] = name;
+    _collectHeadersFunction(_headerKeys,_headerCount);
+  }
+}
+
+/**
+ *  Register f for path, replacing any handler already registered for the same path. If mainThread is set, f is
+ *  dispatched on the thread calling handleClient() even when workers are in use.
+ */
+void WebContext::on(const char* path, HandlerFunction f, bool mainThread) {
+  int route = _routes.add(path);
+  if( route >= 0 ) {
+    growRoutes(route);
+    _handlers[route] = f;
+    if( _metricsEnabled && (_options[route].metrics == NULL) ) _options[route].metrics = new RouteMetrics();
+    if( _profilingEnabled && (_options[route].profile == NULL) ) {_options[route].profile = new HandlerProfile(); _options[route].profile->route = _routes.pattern(route);}
+    if( _options[route].mainThread != mainThread ) _mainThreadRoutes += (mainThread?(1):(-1));
+    _options[route].mainThread = mainThread;
+  }
+}
+
+/**
+ *  Grow the handler and option arrays, indexed by route, to hold route
+ */
+/**
+ *  Called by the default hooks of serving modes the server does not have, so that a device build says the mode is
+ *  ignored rather than serving as before without a word
+ */
+void WebContext::unsupported(const char* mode) {
+  LOG_WARNING("%s is not supported by this server and is ignored",mode);
+}
+
+void WebContext::growRoutes(int route) {
+  if( route < _handlerCapacity ) return;
+  int cap = ((_handlerCapacity > 0)?(2*_handlerCapacity):(8));
+  while( cap <= route ) cap *= 2;
+  HandlerFunction* handlers = new HandlerFunction[cap];
+  RouteOptions*    options  = new RouteOptions[cap];
+  for( int i=0; i<_handlerCapacity; i++ ) {handlers[i] = std::move(_handlers[i]); options[i] = _options[i];}
+  delete [] _handlers;
+  delete [] _options;
+  _handlers        = handlers;
+  _options         = options;
+  _handlerCapacity = cap;
+}
+
+#if defined(ESP8266) || defined(ESP32)
+
+static bool isMultipart(const String& contentType) {return strncasecmp(contentType.c_str(),"multipart/",10) == 0;}
+
+#if WEB_RAW_BODY
+
+/**
+ *  The server passes a body that is not multipart to the upload handler through raw() as it arrives, and body
+ *  takes each piece whole since the server reuses its buffer. A multipart body is left to the server's upload
+ *  parsing.
+ */
+void WebContext::onBody(const char* path, BodyFunction body, HandlerFunction complete) {
+  collectHeader("Content-Type");
+  on(path,complete);
+  _server.on(path,HTTP_POST,[this](){dispatch();},[this,body]() {
+    if( isMultipart(header("Content-Type")) ) return;
+    HTTPRaw& r = _server.raw();
+    if( r.status == RAW_WRITE )        body(this,(const char*)r.buf,r.currentSize,r.totalSize - r.currentSize);
+    else if( r.status == RAW_ABORTED ) body(this,NULL,0,r.totalSize);
+  });
+}
+
+#else
+
+/**
+ *  The server collects the body, passed to body whole from the "plain" argument
+ */
+void WebContext::onBody(const char* path, BodyFunction body, HandlerFunction complete) {
+  on(path,[body,complete](WebContext* c) {
+    const String& b = c->arg("plain");
+    if( b.length() > 0 ) body(c,b.c_str(),b.length(),0);
+    complete(c);
+  });
+}
+
+#endif
+
+/**
+ *  File parts of a multipart body are streamed by the server's upload handler, and the arguments it collects are
+ *  passed as fields before complete. Any other body arrives through raw() where the server has it, and is decoded
+ *  with the route's RouteUpload, or else is collected by the server and passed from its arguments as well.
+ */
+void WebContext::onUpload(const char* path, FieldFunction field, HandlerFunction complete) {
+  int route = _routes.add(path);
+  if( route < 0 ) return;
+  growRoutes(route);
+  delete _options[route].upload;
+  RouteUpload* upload = new RouteUpload(field);
+  _options[route].upload = upload;
+  collectHeader("Content-Type");
+  on(path,[field,complete](WebContext* c) {
+    if( !WEB_RAW_BODY || isMultipart(c->header("Content-Type")) ) {
+      for( int i=0; i<c->argCount(); i++ ) {
+        String    name = c->argName(i);
+        BodyField f;
+        f.name = name.c_str();
+        const String& value = c->arg(i);
+        field(f,value.c_str(),value.length(),true);
+      }
+    }
+    complete(c);
+  });
+  _server.on(path,HTTP_POST,[this](){dispatch();},[this,field,upload]() {
+#if WEB_RAW_BODY
+    if( !isMultipart(header("Content-Type")) ) {
+      HTTPRaw& r = _server.raw();
+      if( r.status == RAW_START )      upload->decoder.begin(header("Content-Type").c_str());
+      else if( r.status == RAW_WRITE ) upload->decoder.write((const char*)r.buf,r.currentSize);
+      else                             upload->decoder.end(r.status == RAW_ABORTED);
+      return;
+    }
+#endif
+    HTTPUpload& u = _server.upload();
+    BodyField   f;
+    f.name        = u.name.c_str();
+    f.filename    = u.filename.c_str();
+    f.contentType = u.type.c_str();
+    f.aborted     = (u.status == UPLOAD_FILE_ABORTED);
+    if( u.status == UPLOAD_FILE_WRITE )                                             field(f,(const char*)u.buf,u.currentSize,false);
+    else if( (u.status == UPLOAD_FILE_END) || (u.status == UPLOAD_FILE_ABORTED) ) field(f,"",0,true);
+  });
+}
+
+#else
+
+void WebContext::onBody(const char* path, BodyFunction body, HandlerFunction complete) {
+  on(path,complete);
+  int route = _routes.add(path);
+  if( route >= 0 ) _options[route].body = body;
+}
+
+/**
+ *  Decode with the route's RouteUpload, taking nothing while it decodes the body of another request. The owner is
+ *  released once its last byte is decoded or its body is cut short, or replaced if it is no longer streaming.
+ */
+void WebContext::onUpload(const char* path, FieldFunction field, HandlerFunction complete) {
+  int route = _routes.add(path);
+  if( route < 0 ) return;
+  growRoutes(route);
+  delete _options[route].upload;
+  RouteUpload* u = new RouteUpload(field);
+  _options[route].upload = u;
+  onBody(path,[u](WebContext* c, const char* data, size_t len, size_t offset)->size_t {
+    const HttpParser* p = c->parser();
+    if( p == NULL ) return len;
+    if( data == NULL ) {
+      if( u->owner == p ) {u->decoder.end(true); u->owner = NULL;}
+      return 0;
+    }
+    if( (u->owner != p) || (offset == 0) ) {
+      if( (u->owner != NULL) && (u->owner != p) && (u->owner->state() == HTTP_STREAM) ) return 0;
+      u->owner = p;
+      u->decoder.begin(p->header("Content-Type"));
+    }
+    u->decoder.write(data,len);
+    if( offset + len == p->contentLength() ) {
+      u->decoder.end();
+      u->owner = NULL;
+    }
+    return len;
+  },complete);
+}
+
+#endif
+
+bool WebContext::streamsBody(const char* uri) {
+  RouteParams params;
+  int route = _routes.match(uri,params);
+  return (route >= 0) && (route < _handlerCapacity) && (_options[route].body != NULL);
+}
+
+/**
+ *  Pass a piece of the streamed body of the current request to the body function of its route, with its path
+ *  arguments. Returns the bytes taken.
+ */
+size_t WebContext::streamBody(const char* data, size_t len, size_t offset) {
+  RequestContext request;
+  RouteParams    params;
+  const String&  uri   = _uriFunction();
+  int            route = _routes.match(uri.c_str(),params);
+  if( (route < 0) || (route >= _handlerCapacity) || (_options[route].body == NULL) ) return len;
+  request.previous = _request;
+  request.pathArgs.set(params);
+  _request = &request;
+  size_t result = _options[route].body(this,data,len,offset);
+  _request = request.previous;
+  return result;
+}
+
+/**
+ *  Subscribe requests to path to a new channel, checking for room before the connection is taken from the server
+ */
+EventChannel* WebContext::sse(const char* path) {
+  EventChannel* channel = new EventChannel();
+  channel->_next = _channels;
+  _channels      = channel;
+  collectHeader("Last-Event-ID");
+  on(path,[channel](WebContext* c) {
+    if( channel->full() ) c->send(503,"text/plain","Too many subscribers");
+    else                  channel->subscribe(c->detach(),c->header("Last-Event-ID").c_str());
+  },true);
+  return channel;
+}
+
+bool WebContext::runsOnMainThread(const char* uri) {
+  if( _mainThreadRoutes == 0 ) return false;
+  RouteParams params;
+  int route = _routes.match(uri,params);
+  return (route >= 0) && _options[route].mainThread;
+}
+
+void WebContext::cacheRoute(const char* path, unsigned long ttl, const char* tag) {
+  int route = _routes.add(path);
+  if( route >= 0 ) {
+    growRoutes(route);
+    _options[route].cached   = true;
+    _options[route].cacheTtl = ttl;
+    _options[route].cacheTag = tag;
+  }
+}
+
+/**
+ *  Append s to key URL encoded, so that '&' and '=' within names and values cannot make two argument sets collide
+ */
+static void appendEncoded(String& key, const String& s) {
+  char   buffer[64];
+  size_t pos = 0;
+  while( pos < s.length() ) {
+    size_t consumed = 0;
+    size_t n = urlEncodeChunk(buffer,sizeof(buffer),s.c_str()+pos,s.length()-pos,consumed);
+    key.concat(buffer,n);
+    pos += consumed;
+  }
+}
+
+/**
+ *  Cache key for the current request, uri followed by its arguments sorted by name and then value. Returns false
+ *  if the request has too many arguments to be cached.
+ */
+bool WebContext::cacheKey(const String& uri, String& key) {
+  int n = argCount();
+  if( n > ARG_INDEX_ARGS ) return false;
+  int order[ARG_INDEX_ARGS];
+  for( int i=0; i<n; i++ ) {
+    int j = i;
+    while( j > 0 ) {
+      int c = strcmp(argName(i).c_str(),argName(order[j-1]).c_str());
+      if( c == 0 ) c = strcmp(arg(i).c_str(),arg(order[j-1]).c_str());
+      if( c >= 0 ) break;
+      order[j] = order[j-1];
+      j--;
+    }
+    order[j] = i;
+  }
+  key = uri;
+  for( int i=0; i<n; i++ ) {
+    key += ((i == 0)?('?'):('&'));
+    appendEncoded(key,argName(order[i]));
+    key += '=';
+    appendEncoded(key,arg(order[i]));
+  }
+  return true;
+}
+
+/**
+ *  Send a cached response as stored, with its length set up front
+ */
+void WebContext::sendCached(const ResponseCache::Entry* e) {
+  const char* h = e->headers.c_str();
+  while( *h != '\0' ) {
+    const char* v   = strchr(h,'\n');
+    const char* end = strchr(v+1,'\n');
+    String name(h,v-h);
+    String value(v+1,end-v-1);
+    _sendHeaderFunction(name.c_str(),value.c_str());
+    h = end+1;
+  }
+  _contentLengthFunction(e->body.length());
+  _sendFunction(e->status,e->contentType.c_str(),"");
+  _sendContentFunction(e->body.c_str(),e->body.length());
+  if( _metricsEnabled ) {
+    _request->status    = e->status;
+    _request->firstByte = micros();
+    _request->bytes    += e->body.length();
+  }
+}
+
+/**
+ *  Response data passing through send(), send_P() and sendContent() during a dispatch, captured for the cache and
+ *  counted for metrics
+ */
+void WebContext::noteSend(int status, const char* contentType, const char* content, bool progmem) {
+  RequestContext& r = *_request;
+  if( r.capture != NULL ) {
+    if( progmem ) r.capture->send_P(status,contentType,content);
+    else          r.capture->send(status,contentType,content);
+  }
+  if( _metricsEnabled ) {
+    if( r.status == 0 ) {r.status = status; r.firstByte = micros();}
+    if( content != NULL ) r.bytes += ((progmem)?(strlen_P(content)):(strlen(content)));
+  }
+  if( r.profile != NULL ) r.profile->sampleHeap();
+}
+
+void WebContext::noteContent(const char* content, size_t len) {
+  RequestContext& r = *_request;
+  if( r.capture != NULL ) r.capture->sendContent(content,len);
+  if( r.profile != NULL ) r.profile->sampleHeap();
+  if( _metricsEnabled ) r.bytes += len;
+}
+
+void WebContext::setOnNotFoundFunction(OnNotFoundFunction f) {
+  if( f != NULL ) {
+    _onNotFoundFunction = f;
+    _onNotFoundFunction([](WebContext* c){c->dispatch();});
+  }
+}
+
+/**
+ *  Index of the argument named name, or -1. Arguments are indexed by name on the first lookup of each request 
+ *  dispatched by WebContext, and scanned outside of a dispatch.
+ */
+int WebContext::argIndex(const char* name) {
+  if( _request == NULL ) {
+    int n = argCount();
+    for( int i=0; i<n; i++ ) {if( argName(i).equals(name) ) return i;}
+    return -1;
+  }
+  ArgIndex& index = _request->argIndex;
+  if( !index.built() ) index.build(argCount(),[this](int i)->ArgView{return argNameView(i);});
+  return index.find(name,[this](int i)->ArgView{return argNameView(i);});
+}
+
+ArgView WebContext::headerView(const char* name) {
+  const HttpParser* p = parser();
+  if( p == NULL ) return ArgView(header(name));
+  int i = p->headerIndex(name);
+  return ArgView(p->headerValue(i),p->headerLength(i));
+}
+
+/**
+ *  Dispatch the current request to its route. A cached route is answered from the cache on a hit, and on a miss
+ *  its response is captured as the handler sends it and stored.
+ */
+void WebContext::dispatch() {
+  RequestContext request;
+  RouteParams    params;
+  request.previous = _request;
+  if( (_request != NULL) && (_request->arena != NULL) ) {
+    request.arena     = _request->arena;
+    request.arenaMark = request.arena->mark();
+  }
+  else {
+    for( int i=0; (i<WEB_ARENAS) && (request.arena == NULL); i++ ) {if( _arenas[i].claim() ) request.arena = &_arenas[i];}
+  }
+  _request = &request;
+  unsigned long start = ((_metricsEnabled)?(micros()):(0));
+  const String& uri = _uriFunction();
+  int route = _routes.match(uri.c_str(),params);
+  if( (route >= 0) && (_handlers[route] != NULL) ) {
+    String key;
+    if( _options[route].cached && cacheKey(uri,key) ) {
+      const ResponseCache::Entry* e = _cache.acquire(key);
+      if( e != NULL ) {
+        sendCached(e);
+        _cache.release(e);
+      }
+      else {
+        ResponseCapture capture(_cache.budget());
+        request.capture = &capture;
+        request.pathArgs.set(params);
+        invoke(_handlers[route],_options[route].profile);
+        request.capture = NULL;
+        _cache.store(key,_options[route].cacheTag,_options[route].cacheTtl,capture);
+      }
+    }
+    else {
+      request.pathArgs.set(params);
+      invoke(_handlers[route],_options[route].profile);
+    }
+  }
+  else if( _notFoundHandler != NULL ) invoke(_notFoundHandler,_notFoundProfile);
+  else send(404,"text/plain","Not Found");
+  if( _metricsEnabled ) record((((route >= 0) && (_handlers[route] != NULL))?(_options[route].metrics):(_notFoundMetrics)),request,start);
+  if( request.arena != NULL ) {
+    if( (request.previous != NULL) && (request.previous->arena == request.arena) ) request.arena->rewind(request.arenaMark);
+    else                                                                             request.arena->release();
+  }
+  _request = request.previous;
+}
+
+/**
+ *  Call f for the current request, profiled when profile is set
+ */
+void WebContext::invoke(HandlerFunction& f, HandlerProfile* profile) {
+  if( profile == NULL ) {f(this); return;}
+  ProfileScope scope(profile);
+  _request->profile = &scope;
+  f(this);
+  _request->profile = NULL;
+  scope.end();
+}
+
+const char* WebContext::format(const char* format, ...) {
+  RequestArena* a = arena();
+  if( a == NULL ) return NULL;
+  va_list args;
+  va_start(args,format);
+  const char* result = a->vformat(false,format,args);
+  va_end(args);
+  return result;
+}
+
+const char* WebContext::format_P(PGM_P format, ...) {
+  RequestArena* a = arena();
+  if( a == NULL ) return NULL;
+  va_list args;
+  va_start(args,format);
+  const char* result = a->vformat(true,format,args);
+  va_end(args);
+  return result;
+}
+
+size_t WebContext::arenaHighWater() const {
+  size_t result = 0;
+  for( const RequestArena& a : _arenas ) {if( a.highWater() > result ) result = a.highWater();}
+  return result;
+}
+
+unsigned long WebContext::arenaOverflows() const {
+  unsigned long result = 0;
+  for( const RequestArena& a : _arenas ) result += a.overflows();
+  return result;
+}
+
+/**
+ *  Record a completed request. Time to first byte is measured from when the server received the request, if it
+ *  reports that, and latency from dispatch to the handler's return.
+ */
+void WebContext::record(RouteMetrics* m, const RequestContext& r, unsigned long start) {
+  if( m == NULL ) return;
+  unsigned long arrived = _requestStartFunction();
+  if( (arrived == 0) || ((long)(start - arrived) < 0) ) arrived = start;
+  m->record(r.status,r.bytes,micros()-start,((r.status != 0)?(r.firstByte-arrived):(0)));
+}
+
+void WebContext::enableMetrics(const char* path) {
+  if( !_metricsEnabled ) {
+    _metricsEnabled = true;
+    for( int i=0; i<_handlerCapacity; i++ ) {if( (_handlers[i] != NULL) && (_options[i].metrics == NULL) ) _options[i].metrics = new RouteMetrics();}
+    _notFoundMetrics = new RouteMetrics();
+  }
+  if( path != NULL ) on(path,[](WebContext* c){c->writeMetrics();});
+}
+
+const RouteMetrics* WebContext::routeMetrics(const char* path) {
+  RouteParams params;
+  int route = ((path != NULL)?(_routes.match(path,params)):(-1));
+  return (((route >= 0) && (route < _handlerCapacity))?(_options[route].metrics):(_notFoundMetrics));
+}
+
+void WebContext::enableLog(const char* path) {
+  on(path,[](WebContext* c){
+    ResponseWriter w(c);
+    w.begin(200,TEXT_PLAIN);
+    Log.history([&w](const char* text, size_t len){w.write(text,len);});
+    if( Log.dropped() > 0 ) w.printf("%lu records dropped\n",Log.dropped());
+    w.end();
+  });
+}
+
+void WebContext::enableProfiling(const char* path) {
+  if( !_profilingEnabled ) {
+    _profilingEnabled = true;
+    for( int i=0; i<_handlerCapacity; i++ ) {
+      if( (_handlers[i] != NULL) && (_options[i].profile == NULL) ) {_options[i].profile = new HandlerProfile(); _options[i].profile->route = _routes.pattern(i);}
+    }
+    _notFoundProfile = new HandlerProfile();
+    _notFoundProfile->route = "notFound";
+  }
+  if( path != NULL ) on(path,[](WebContext* c){c->writeProfile();});
+}
+
+/**
+ *  Insertion into out, which stays sorted, so the cost is max per route rather than a sort of every route
+ */
+int WebContext::worstHandlers(HandlerProfile out[], int max, ProfileOrder order) {
+  int count = 0;
+  for( int i=0; i<=_handlerCapacity; i++ ) {
+    HandlerProfile* p = ((i < _handlerCapacity)?(_options[i].profile):(_notFoundProfile));
+    if( (p == NULL) || (max <= 0) ) continue;
+    HandlerProfile s = profileSnapshot(*p);
+    if( s.calls == 0 ) continue;
+    long key = ((order == PROFILE_STACK)?((long)s.stackPeak):(s.heapPeak));
+    int  j   = ((count < max)?(count++):(max));
+    while( (j > 0) && (key > ((order == PROFILE_STACK)?((long)out[j-1].stackPeak):(out[j-1].heapPeak))) ) {
+      if( j < max ) out[j] = out[j-1];
+      j--;
+    }
+    if( j < max ) out[j] = s;
+  }
+  return count;
+}
+
+void WebContext::writeProfile() {
+  int count = 0;
+  for( int i=0; i<_handlerCapacity; i++ ) {if( _options[i].profile != NULL ) count++;}
+  HandlerProfile* profiles = alloc<HandlerProfile>(count+1);
+  if( profiles == NULL ) {send(500,"text/plain","No request arena"); return;}
+  count = worstHandlers(profiles,count+1);
+  ResponseWriter w(this);
+  w.begin(200,TEXT_PLAIN);
+  w.printf("%-32s %10s %8s %10s %10s %12s\n","route","calls","stack","heapPeak","heapDelta","heapRetained");
+  for( int i=0; i<count; i++ ) {
+    const HandlerProfile& p = profiles[i];
+    w.printf("%-32s %10lu %7u%s %10ld %10ld %12ld\n",p.route,p.calls,(unsigned)p.stackPeak,((p.stackSaturated)?("+"):(" ")),p.heapPeak,p.heapDelta,p.heapRetained);
+  }
+  w.end();
+}
+
+/**
+ *  Write s as a Prometheus label value, escaping '\\', '"' and newline
+ */
+static void writeLabel(ResponseWriter& w, const char* s) {
+  const char* run = s;
+  for( ; *s != '\0'; s++ ) {
+    if( (*s == '\\') || (*s == '"') || (*s == '\n') ) {
+      w.write(run,s-run);
+      w.write(((*s == '\n')?("\\n"):((*s == '"')?("\\\""):("\\\\"))));
+      run = s+1;
+    }
+  }
+  w.write(run,s-run);
+}
+
+/**
+ *  64 bit count in decimal, without relying on %llu support in printf
+ */
+static void writeCount(ResponseWriter& w, uint64_t n) {
+  if( n >= 1000000000 ) w.printf("%lu%09lu",(unsigned long)(n/1000000000),(unsigned long)(n%1000000000));
+  else                  w.printf("%lu",(unsigned long)n);
+}
+
+static void writeSeconds(ResponseWriter& w, uint64_t us) {
+  w.printf("%lu.%06lu",(unsigned long)(us/1000000),(unsigned long)(us%1000000));
+}
+
+static void writeHistogram(ResponseWriter& w, const char* name, const char* route, const LatencyHistogram& h) {
+  uint32_t cumulative = 0;
+  for( int i=0; i<METRIC_BUCKETS; i++ ) {
+    cumulative += h.bucket(i);
+    w.printf("%s_bucket{route=\"",name);
+    writeLabel(w,route);
+    w.write("\",le=\"");
+    writeSeconds(w,LatencyHistogram::bound(i));
+    w.printf("\"} %lu\n",(unsigned long)cumulative);
+  }
+  w.printf("%s_bucket{route=\"",name);
+  writeLabel(w,route);
+  w.printf("\",le=\"+Inf\"} %lu\n%s_sum{route=\"",(unsigned long)h.count(),name);
+  writeLabel(w,route);
+  w.write("\"} ");
+  writeSeconds(w,h.sum());
+  w.printf("\n%s_count{route=\"",name);
+  writeLabel(w,route);
+  w.printf("\"} %lu\n",(unsigned long)h.count());
+}
+
+/**
+ *  Metrics in Prometheus text exposition format, one family at a time across routes. Requests that matched no route
+ *  are reported as route "notFound".
+ */
+void WebContext::writeMetrics() {
+  ResponseWriter w(this);
+  w.begin(200,"text/plain; version=0.0.4");
+  int count = _handlerCapacity + 1;
+  auto metrics = [this](int i)->const RouteMetrics* {return ((i < _handlerCapacity)?(_options[i].metrics):(_notFoundMetrics));};
+  auto route   = [this](int i)->const char* {return ((i < _handlerCapacity)?(_routes.pattern(i)):("notFound"));};
+
+  w.write("# HELP web_requests_total Requests dispatched, by route and status code, with codes not counted on their own by class\n"
+          "# TYPE web_requests_total counter\n");
+  for( int i=0; i<count; i++ ) {
+    const RouteMetrics* m = metrics(i);
+    for( int s=0; (m != NULL) && (s<METRIC_STATUS); s++ ) {
+      if( m->requests(s) == 0 ) continue;
+      w.write("web_requests_total{route=\"");
+      writeLabel(w,route(i));
+      w.printf("\",code=\"%s\"} %lu\n",RouteMetrics::status(s),(unsigned long)m->requests(s));
+    }
+  }
+  w.write("# HELP web_response_bytes_total Content bytes sent, by route\n# TYPE web_response_bytes_total counter\n");
+  for( int i=0; i<count; i++ ) {
+    const RouteMetrics* m = metrics(i);
+    if( m == NULL ) continue;
+    w.write("web_response_bytes_total{route=\"");
+    writeLabel(w,route(i));
+    w.write("\"} ");
+    writeCount(w,m->bytes());
+    w.write("\n");
+  }
+  w.write("# HELP web_request_duration_seconds Handler latency, by route\n# TYPE web_request_duration_seconds histogram\n");
+  for( int i=0; i<count; i++ ) {if( metrics(i) != NULL ) writeHistogram(w,"web_request_duration_seconds",route(i),metrics(i)->latency);}
+  w.write("# HELP web_first_byte_seconds Time from request arrival to first response byte, by route\n# TYPE web_first_byte_seconds histogram\n");
+  for( int i=0; i<count; i++ ) {if( metrics(i) != NULL ) writeHistogram(w,"web_first_byte_seconds",route(i),metrics(i)->firstByte);}
+  w.end();
+}
+
+void WebContext::serveStatic_P(const char* path, PGM_P contentType, PGM_P content, unsigned long maxAge) {
+  collectHeader("If-None-Match");
+  size_t len = strlen_P(content);
+  char   etag[32];
+  char   cacheControl[24];
+  snprintf(etag,sizeof(etag),"\"%08lx-%lx\"",(unsigned long)fnv1a_P(content,len),(unsigned long)len);
+  snprintf(cacheControl,sizeof(cacheControl),"max-age=%lu",maxAge);
+  String tag(etag);
+  String cc(cacheControl);
+  on(path,[tag,cc,contentType,content](WebContext* c) {
+    c->sendHeader("ETag",tag.c_str());
+    c->sendHeader("Cache-Control",cc.c_str());
+    const String& match = c->header("If-None-Match");
+    if( (match == "*") || (strstr(match.c_str(),tag.c_str()) != NULL) ) c->send_P(304,contentType,"");
+    else                                                                 c->send_P(200,contentType,content);
+  });
+}
+
+/**
+ *   Send the gzip form when any Accept-Encoding entry names gzip. A q=0 weight is not checked for, since
+ *   browsers that accept gzip never send it.
+ */
+static bool acceptsGzip(WebContext* c, const ProgmemAsset& asset) {
+  return (asset.gzip != NULL) && (strstr(c->header("Accept-Encoding").c_str(),"gzip") != NULL);
+}
+
+void WebContext::send_P(int statusCode, const ProgmemAsset& asset) {
+  bool gzip = acceptsGzip(this,asset);
+  if( asset.gzip != NULL ) sendHeader("Vary","Accept-Encoding");
+  if( gzip )               sendHeader("Content-Encoding","gzip");
+  ResponseWriter w(this);
+  w.begin(statusCode,asset.contentType,((gzip)?(asset.gzipLength):(asset.length)));
+  w.write_P(((gzip)?(asset.gzip):(asset.content)),((gzip)?(asset.gzipLength):(asset.length)));
+  w.end();
+}
+
+void WebContext::serveStatic_P(const char* path, const ProgmemAsset& asset, unsigned long maxAge) {
+  collectHeader("If-None-Match");
+  collectHeader("Accept-Encoding");
+  char   etag[32];
+  char   gzipEtag[36];
+  char   cacheControl[24];
+  snprintf(etag,sizeof(etag),"\"%08lx-%lx\"",(unsigned long)asset.hash,(unsigned long)asset.length);
+  snprintf(gzipEtag,sizeof(gzipEtag),"\"%08lx-%lx-gz\"",(unsigned long)asset.hash,(unsigned long)asset.length);
+  snprintf(cacheControl,sizeof(cacheControl),"max-age=%lu",maxAge);
+  String tag(etag);
+  String gzipTag(gzipEtag);
+  String cc(cacheControl);
+  ProgmemAsset a = asset;
+  on(path,[tag,gzipTag,cc,a](WebContext* c) {
+    const String& etag = ((acceptsGzip(c,a))?(gzipTag):(tag));
+    c->sendHeader("ETag",etag.c_str());
+    c->sendHeader("Cache-Control",cc.c_str());
+    const String& match = c->header("If-None-Match");
+    if( (match == "*") || (strstr(match.c_str(),etag.c_str()) != NULL) ) {
+      if( a.gzip != NULL ) c->sendHeader("Vary","Accept-Encoding");
+      c->send_P(304,a.contentType,"");
+    }
+    else c->send_P(200,a);
+  });
+}
 
 } // End of namespace lsc
 
@@ -21,8 +21,15 @@
  */
 
 /** Class to Wrap minimal Web Server functionality necessary to implement 
- *  UPnPDevices. WebContext will wrap ESP8266WebServer and (ESP32) WebServer. 
+ *  UPnPDevices. WebContext will wrap ESP8266WebServer and (ESP32) WebServer, and 
+ *  HostServer when built natively on a Linux host. 
  *  Any other web server implementation should implement a subclass.
+ *
+ *  Handlers registered with on() are kept in a RouteTable owned by WebContext rather than
+ *  by the server, and dispatched from the server's not found handler, so dispatch cost does
+ *  not grow with the number of routes. Paths may contain {param} segments, available to the 
+ *  handler with pathArg():
+ *     ctx.on("/{device}/nearbyDevices",[](WebContext* c){Serial.printf("%s\n",c->pathArg("device"));});
  *  
  *  This is not all-inclusive but adaquate for UPnPDevices and should be implementable
  *  for a variety of additional Web Servers 
@@ -31,16 +38,45 @@
 #ifndef WEB_CONTEXT_H
 #define WEB_CONTEXT_H
 
+#ifdef ARDUINO
 #include <Arduino.h>
-#include <functional>
 #include <IPAddress.h>
+#else
+#include "HostPlatform.h"
+#endif
+#include <functional>
+#include "RouteTable.h"
+#include "ArgIndex.h"
+#include "ResponseCache.h"
+#include "RequestArena.h"
+#include "RouteMetrics.h"
+#include "HandlerProfile.h"
+#include "HttpParser.h"
+#include "BodyDecoder.h"
+#include "EventChannel.h"
 
 #ifdef ESP8266
 #include <ESP8266WebServer.h>
 #include <ESP8266WiFi.h>
+#include <core_version.h>
 #elif defined(ESP32)
 #include <WebServer.h>
 #include <WiFi.h>
+#elif defined(LSC_HOST)
+#include "HostServer.h"
+#endif
+
+/**
+ *  ESP8266 core 3.0 and arduino-esp32 2.0 pass a POST body that is not multipart to the upload handler through
+ *  raw(), in pieces as it arrives, and onBody() and onUpload() stream it from there. Earlier cores have no raw(),
+ *  and collect the body into the "plain" argument instead. Define as 0 to collect bodies on any core.
+ */
+#ifndef WEB_RAW_BODY
+#if (defined(ESP8266) && defined(ARDUINO_ESP8266_MAJOR) && (ARDUINO_ESP8266_MAJOR >= 3)) || (defined(ESP32) && defined(ESP_ARDUINO_VERSION_MAJOR) && (ESP_ARDUINO_VERSION_MAJOR >= 2))
+#define WEB_RAW_BODY         1
+#else
+#define WEB_RAW_BODY         0
+#endif
 #endif
 
 /** Leelanau Software Company namespace 
@@ -48,51 +84,327 @@
 */
 namespace lsc {
 
+#ifdef ESP32
+/**
+ *   WebServer::arg(), argName() and header() return a copy of the String. ArgWebServer reads the request arguments
+ *   and collected headers in place, so WebContext can return references that stay valid for the whole request.
+ */
+class ArgWebServer : public WebServer {
+  public:
+  ArgWebServer(int port=80) : WebServer(port) {}
+
+  const String& argRef(int i)                                        {return (((i >= 0) && (i < _currentArgCount))?(_currentArgs[i].value):(_none));}
+  const String& argNameRef(int i)                                    {return (((i >= 0) && (i < _currentArgCount))?(_currentArgs[i].key):(_none));}
+  const String& headerRef(const char* name) {
+    for( int i=0; i<_headerKeysCount; i++ ) {if( strcasecmp(_currentHeaders[i].key.c_str(),name) == 0 ) return _currentHeaders[i].value;}
+    return _none;
+  }
+
+  private:
+  const String _none;
+};
+#endif
+
 class WebContext;
 typedef std::function<void(void)> ClientHandler;                                                          // WebServer::handleClient() function
 typedef std::function<const String&(void)> URIFunction;                                                   // WebServer::uri() function to return current URI on Http Request
 typedef std::function<void(WebContext*)> HandlerFunction;                                                 // Web Request Handler, set on WebServer::on()
+typedef std::function<size_t(WebContext*, const char* data, size_t len, size_t offset)> BodyFunction;     // Streamed request body, returning the bytes taken
 typedef std::function<void(int statusCode, const char* contentType, const char*  content)> SendFunction;  // WebServer::send to send Http Response
 typedef std::function<void(int statusCode, PGM_P contentType, PGM_P  content)> Send_PFunction;            // WebServer::send_P variant for Http Response
-typedef std::function<void(const char* path, HandlerFunction)> OnFunction;                                // WebServer::on() to Register a HandlerFunction
+typedef std::function<void(const char* path, HandlerFunction)> OnFunction;                                // WebServer::on() to Register a HandlerFunction, not used by WebContext::on()
 typedef std::function<void(HandlerFunction)> OnNotFoundFunction;                                          // WebServer::onNotFound() to register a ClientHandler when URI is not found
 typedef std::function<void(RequestHandler*)> AddHandlerFunction;                                          // WebServer::addHandler() to add HTTP RequestHandler
 typedef std::function<int(void)> ArgCountFunction;                                                        // WebServer::argCount() returning number of arguments on current Http Request
 typedef std::function<const String&(int)> ArgFunction;                                                    // WebServer::arg(int i) function to return request argument i (name or value)
 typedef std::function<WiFiClient(void)> WiFiClientFunction;                                               // WebServer::client() to return WiFiClient
 typedef std::function<void(void)> CloseFunction;                                                          // WebServer::close() function
+typedef std::function<void(size_t len)> ContentLengthFunction;                                            // WebServer::setContentLength() for the next response, CONTENT_LENGTH_UNKNOWN for chunked
+typedef std::function<void(const char* content, size_t len)> SendContentFunction;                         // WebServer::sendContent() to send additional response content
+typedef std::function<void(const char* name, const char* value)> SendHeaderFunction;                      // WebServer::sendHeader() to add a header to the next response
+typedef std::function<void(const char* names[], size_t count)> CollectHeadersFunction;                    // WebServer::collectHeaders() to set request headers to be retained
+typedef std::function<const String&(const char* name)> HeaderFunction;                                    // WebServer::header(name) to return a collected request header
+typedef std::function<void(int n)> MaxConnectionsFunction;                                                // Connections served at once by handleClient(), where the server supports it
+typedef std::function<void(int n)> WorkersFunction;                                                       // Worker threads dispatching requests, where the server supports it
+typedef std::function<void(unsigned long timeout, int maxRequests)> KeepAliveFunction;                    // Persistent connection limits, where the server supports it
+typedef std::function<unsigned long(void)> RequestStartFunction;                                          // micros() when the current request arrived, 0 if the server does not know
+typedef std::function<const HttpParser*(void)> ParserFunction;                                            // The current request as parsed, where the server parses with HttpParser
+typedef std::function<WiFiClient(void)> DetachFunction;                                                   // Take the current connection from the server, to keep it open after the handler
+
+#ifndef WEB_MAX_HEADERS
+#define WEB_MAX_HEADERS      8
+#endif
+#ifndef WEB_CACHE_MAX_AGE
+#define WEB_CACHE_MAX_AGE    3600
+#endif
+#ifndef WEB_KEEP_ALIVE_MAX
+#define WEB_KEEP_ALIVE_MAX   100
+#endif
+
+#if defined(LSC_HOST) || defined(ESP32)
+#define WEB_THREAD_LOCAL     thread_local
+#else
+#define WEB_THREAD_LOCAL
+#endif
+
+#ifdef LSC_HOST
+#define WEB_ARENAS           (HOST_MAX_WORKERS+1)          // One per thread that can dispatch at once
+#else
+#define WEB_ARENAS           1
+#endif
+
+/**
+ *   Per-request state of a dispatch, held on the stack of the dispatching thread so that requests dispatched by
+ *   different threads share nothing. Reached through a thread local pointer while the handler runs.
+ */
+struct RequestContext {
+  RouteArgs          pathArgs;
+  ArgIndex           argIndex;
+  ResponseCapture*   capture  = NULL;          // Set while a cached route renders
+  int                status   = 0;             // Response status, bytes and micros() of the first send, for metrics
+  size_t             bytes    = 0;
+  unsigned long      firstByte = 0;
+  ProfileScope*      profile  = NULL;          // Set while a profiled handler runs
+  RequestArena*      arena    = NULL;          // Scratch memory of the request, shared with an enclosing dispatch
+  size_t             arenaMark = 0;
+  RequestContext*    previous = NULL;
+};
+
+/**
+ *   Connection reuse counters. reused counts requests served on a connection that had already served one, so
+ *   reused/requests is the share of requests that skipped connection setup.
+ */
+struct ConnectionStats {
+  unsigned long      accepted = 0;
+  unsigned long      requests = 0;
+  unsigned long      reused   = 0;
+};
+typedef std::function<ConnectionStats(void)> ConnectionStatsFunction;                                      // Connection reuse counters, where the server supports them
 
 class WebContext {
 
   public:
   WebContext() {}
+  ~WebContext();
 
   void       setSendFunction( SendFunction f)                                         {if(f != NULL) _sendFunction = f;}
   void       setClientHandler(ClientHandler f)                                        {if(f != NULL) _handleClient = f;}
   void       setURIFunction( URIFunction f)                                           {if(f != NULL) _uriFunction = f;}
   void       setSend_PFunction( Send_PFunction f)                                     {if(f != NULL) _send_PFunction = f;}
   void       setOnFunction( OnFunction f)                                             {if(f != NULL) _onFunction = f;}
-  void       setOnNotFoundFunction( OnNotFoundFunction f)                             {if(f != NULL) _onNotFoundFunction = f;}
+  void       setOnNotFoundFunction( OnNotFoundFunction f);
   void       setAddHandlerFunction(AddHandlerFunction f)                              {if(f != NULL) _addHandlerFunction = f;}
   void       setArgCountFunction( ArgCountFunction f)                                 {if(f != NULL) _argCountFunction = f;}
   void       setArgFunction( ArgFunction f)                                           {if(f != NULL) _argFunction = f;}
   void       setArgNameFunction( ArgFunction f)                                       {if(f != NULL) _argNameFunction = f;}
   void       setWiFiClientFunction(WiFiClientFunction f)                              {if(f != NULL) _wifiClientFunction = f;}
   void       setCloseFunction(CloseFunction f)                                        {if(f != NULL) _closeFunction = f;}
+  void       setContentLengthFunction(ContentLengthFunction f)                        {if(f != NULL) _contentLengthFunction = f;}
+  void       setSendContentFunction(SendContentFunction f)                            {if(f != NULL) _sendContentFunction = f;}
+  void       setSendHeaderFunction(SendHeaderFunction f)                              {if(f != NULL) _sendHeaderFunction = f;}
+  void       setCollectHeadersFunction(CollectHeadersFunction f)                      {if(f != NULL) _collectHeadersFunction = f;}
+  void       setHeaderFunction(HeaderFunction f)                                      {if(f != NULL) _headerFunction = f;}
+  void       setMaxConnectionsFunction(MaxConnectionsFunction f)                      {if(f != NULL) _maxConnectionsFunction = f;}
+  void       setWorkersFunction(WorkersFunction f)                                    {if(f != NULL) _workersFunction = f;}
+  void       setKeepAliveFunction(KeepAliveFunction f)                                {if(f != NULL) _keepAliveFunction = f;}
+  void       setConnectionStatsFunction(ConnectionStatsFunction f)                    {if(f != NULL) _connectionStatsFunction = f;}
+  void       setRequestStartFunction(RequestStartFunction f)                          {if(f != NULL) _requestStartFunction = f;}
+  void       setParserFunction(ParserFunction f)                                      {if(f != NULL) _parserFunction = f;}
+  void       setDetachFunction(DetachFunction f)                                      {if(f != NULL) _detachFunction = f;}
 
-  void       send(int statusCode, const char* const contentType, const char* content) {_sendFunction(statusCode, contentType, content);}
-  void       send_P(int statusCode, PGM_P contentType, PGM_P content)                 {_send_PFunction(statusCode, contentType, content);}
-  void       on(const char* path, HandlerFunction f)                                  {_onFunction(path,f);}
-  void       onNotFound(HandlerFunction f)                                            {_onNotFoundFunction(f);}
+  void       send(int statusCode, const char* const contentType, const char* content) {if(_request != NULL) noteSend(statusCode,contentType,content,false); _sendFunction(statusCode, contentType, content);}
+  void       send_P(int statusCode, PGM_P contentType, PGM_P content)                 {if(_request != NULL) noteSend(statusCode,contentType,content,true); _send_PFunction(statusCode, contentType, content);}
+  void       on(const char* path, HandlerFunction f, bool mainThread=false);
+  void       onNotFound(HandlerFunction f)                                            {_notFoundHandler = f;}
   void       addHandler(RequestHandler* h)                                            {_addHandlerFunction(h);}
   int        argCount()                                                               {return _argCountFunction();}
   int        getLocalPort()                                                           {return _port;}
   const      String& arg(int i)                                                       {return _argFunction(i);}
   const      String& argName(int i)                                                   {return _argNameFunction(i);}
-  void       handleClient()                                                           {_handleClient();}
+  const      String& arg(const char* name)                                            {int i = argIndex(name); return ((i >= 0)?(arg(i)):(_empty));}
+  bool       hasArg(const char* name)                                                 {return argIndex(name) >= 0;}
+  int        argIndex(const char* name);
+
+/**
+ *   Read-only views of request arguments, valid until the request completes. Views do not copy, and unlike the
+ *   String returned by arg() a later call does not invalidate an earlier view. Where the server parses with
+ *   HttpParser (HostServer) views point into its receive buffer and no String is built, and headerView() finds any
+ *   header, collected or not. Elsewhere they view the server's Strings.
+ */
+  ArgView    argView(int i)                                                           {const HttpParser* p = parser(); return ((p != NULL)?(ArgView(p->arg(i),p->argLength(i))):(ArgView(arg(i))));}
+  ArgView    argNameView(int i)                                                       {const HttpParser* p = parser(); return ((p != NULL)?(ArgView(p->argName(i),p->argNameLength(i))):(ArgView(argName(i))));}
+  ArgView    argView(const char* name)                                                {int i = argIndex(name); return ((i >= 0)?(argView(i)):(ArgView()));}
+  ArgView    headerView(const char* name);
+
+/**
+ *   The current request as parsed by HttpParser, or NULL where the server parses requests itself (ESP8266WebServer
+ *   and WebServer)
+ */
+  const HttpParser* parser()                                                          {return _parserFunction();}
+  void       handleClient()                                                           {_handleClient(); for( EventChannel* e=_channels; e!=NULL; e=e->_next ) e->poll();}
+
+/**
+ *   The connection of the current request, taken from the server so that it stays open after the handler returns.
+ *   The handler writes the response to it directly, and the server sends nothing more for the request. A request
+ *   with no connection to take, such as one from inject(), returns an unconnected client instead.
+ */
+  WiFiClient detach()                                                                 {return _detachFunction();}
+
+/**
+ *   Register a Server-Sent Events stream at path and return its channel, owned by the WebContext. Each GET of path
+ *   subscribes, up to EVENT_MAX_CLIENTS at once, and further requests are answered 503. The route runs on the thread
+ *   calling handleClient(), which also polls the channel, so send() should be called from that thread too. Call
+ *   after begin(). See EventChannel.h.
+ */
+  EventChannel* sse(const char* path);
+
+/**
+ *   Serve up to n connections at once, with handleClient() advancing each by a bounded step rather than serving
+ *   one request to completion. 0 restores one request per handleClient(). Only HostServer, the Linux build, has
+ *   this mode (see HostServer.h). ESP8266WebServer and WebServer still serve one client per handleClient() to
+ *   completion, so on devices it changes nothing and logs a warning.
+ */
+  void       setMaxConnections(int n)                                                 {_maxConnectionsFunction(n);}
+
+/**
+ *   Dispatch requests on a pool of n worker threads, with setMaxConnections() also set, so that handlers run on
+ *   every core. Handlers registered with on(path,f,true) keep running on the thread calling handleClient(). Each
+ *   request has its own args, path args and response state, but handlers run on workers must not share other
+ *   state without locking. The pool is host-only: it is part of HostServer's event-driven mode, and ESP32 builds,
+ *   dual core or not, dispatch every handler on the thread calling handleClient() as before and log a warning.
+ */
+  void       setWorkers(int n)                                                        {_workersFunction(n);}
+
+/**
+ *   Keep HTTP/1.1 connections open for up to maxRequests requests, closing them after timeout ms idle, with
+ *   pipelined requests answered in order. 0 closes each connection after its response. Requires
+ *   setMaxConnections(); supported by HostServer, ignored by ESP8266WebServer and WebServer.
+ */
+  void       setKeepAlive(unsigned long timeout, int maxRequests=WEB_KEEP_ALIVE_MAX)  {_keepAliveFunction(timeout,maxRequests);}
+  ConnectionStats connectionStats()                                                   {return _connectionStatsFunction();}
+
+/**
+ *   Scratch memory for the current request from a RequestArena, released when the handler returns. scratch()
+ *   returns len bytes, alloc() count objects of type T (not constructed), and format() and format_P() a '\0'
+ *   terminated printf style string. All return NULL outside a dispatch. See RequestArena.h.
+ */
+  char*      scratch(size_t len)                                                      {RequestArena* a = arena(); return ((a != NULL)?(a->scratch(len)):(NULL));}
+  template<typename T>
+  T*         alloc(size_t count=1)                                                    {RequestArena* a = arena(); return ((a != NULL)?(a->alloc<T>(count)):(NULL));}
+  const char* format(const char* format, ...);
+  const char* format_P(PGM_P format, ...);
+
+/**
+ *   Arena capacity in bytes, applied to each arena from its next request, and usage since begin(): the most any
+ *   request used and the number of allocations that overflowed to the heap
+ */
+  void       setArenaSize(size_t bytes)                                               {for( RequestArena& a : _arenas ) a.setCapacity(bytes);}
+  size_t     arenaHighWater() const;
+  unsigned long arenaOverflows() const;
+
   String     uri()                                                                    {return _uriFunction();}
   WiFiClient client()                                                                 {return _wifiClientFunction();}
   void       close()                                                                  {_closeFunction();}
+  void       setContentLength(size_t len)                                             {_contentLengthFunction(len);}
+  void       sendContent(const char* content, size_t len)                             {if(_request != NULL) noteContent(content,len); _sendContentFunction(content,len);}
+  void       sendHeader(const char* name, const char* value)                          {if(capturing()) _request->capture->sendHeader(name,value); _sendHeaderFunction(name,value);}
+  const      String& header(const char* name)                                         {return _headerFunction(name);}
+  void       collectHeader(const char* name);
+
+/**
+ *   Path arguments captured by {param} segments of the route being handled. Values are '\0' terminated copies, valid
+ *   until the handler returns, and pathArg(name) returns NULL if the route has no such param.
+ */
+  int        pathArgCount() const                                                     {return ((_request != NULL)?(_request->pathArgs.count()):(0));}
+  const char* pathArg(int i) const                                                    {return ((_request != NULL)?(_request->pathArgs.value(i)):(NULL));}
+  const char* pathArgName(int i) const                                                {return ((_request != NULL)?(_request->pathArgs.name(i)):(NULL));}
+  const char* pathArg(const char* name) const                                         {return ((_request != NULL)?(_request->pathArgs.value(name)):(NULL));}
+
+/**
+ *   Match the current request URI against registered routes and call its handler, or the not found handler if none
+ *   matches. Installed as the server's not found handler by setOnNotFoundFunction().
+ */
+  void       dispatch();
+
+/**
+ *   True if the route matching uri was registered with mainThread set
+ */
+  bool       runsOnMainThread(const char* uri);
+
+/**
+ *   Cache responses of the route registered for path, keyed by URI and arguments, for ttl ms (0 until invalidated)
+ *   under tag. A hit is sent from the stored response without calling the handler. Only complete 200 responses
+ *   sent through this WebContext are stored, so handlers that write to client() directly must not be cached, and
+ *   cached routes should not change state. See ResponseCache.h.
+ */
+  void       cacheRoute(const char* path, unsigned long ttl, const char* tag=NULL);
+  void       invalidateCache(const char* tag=NULL)                                    {_cache.invalidate(tag);}
+  void       setCacheBudget(size_t bytes)                                             {_cache.setBudget(bytes);}
+  ResponseCache& responseCache()                                                      {return _cache;}
+
+/**
+ *   Count requests by status code, content bytes sent, handler latency and time to first byte for every route, and
+ *   serve them at path in Prometheus text format. Time to first byte runs from when the server received the request
+ *   where it reports that (HostServer), otherwise from dispatch. Counters are fixed size per route and updated with
+ *   no heap use or floating point, see RouteMetrics.h.
+ */
+  void       enableMetrics(const char* path="/metrics");
+  const RouteMetrics* routeMetrics(const char* path);
+
+/**
+ *   Serve the lines drained from Log (see Logger.h) at path as text/plain, oldest first. Only drained records are
+ *   shown, so the route reads the history and never formats or waits on the ring. On ESP8266 the history is empty
+ *   unless LOG_HISTORY_BYTES is defined for the build, see Logger.h.
+ */
+  void       enableLog(const char* path="/log");
+
+/**
+ *   Record peak stack depth, peak heap and heap kept after return for every handler, see HandlerProfile.h, and serve
+ *   the table at path as text/plain, deepest stack first. Pass NULL for no route. worstHandlers() copies up to max
+ *   profiles into out, in order, and returns how many it copied.
+ */
+  void       enableProfiling(const char* path="/profile");
+  int        worstHandlers(HandlerProfile out[], int max, ProfileOrder order=PROFILE_STACK);
+
+/**
+ *   Handle POST bodies at path as they arrive instead of collecting them first, for uploads larger than memory.
+ *   onBody() passes the raw body to body in pieces, len bytes at offset in the body, and body returns the bytes it
+ *   took; taking none holds the rest of the body back until it is called again. onUpload() decodes the body with
+ *   a BodyDecoder (see BodyDecoder.h) and passes field the data of each form field or file part, or of the whole
+ *   body as the field "plain" if it is not a form. complete is dispatched as the handler of path once the body has
+ *   been taken, and path may have {param} segments, with pathArg() available to body as well. A body cut short,
+ *   by its connection closing or a multipart body missing its closing boundary, ends with a call to body with data
+ *   NULL, or to field with BodyField::aborted set. HostServer does not dispatch complete once the connection has
+ *   closed.
+ *
+ *   With HostServer bodies are streamed straight from its receive buffer, on the thread calling handleClient(),
+ *   and one upload to a path is decoded at a time. ESP8266WebServer and WebServer stream multipart file parts to
+ *   field through their upload handler, with the other fields of a multipart body collected as arguments and passed
+ *   to field before complete. Other bodies are streamed through raw() where WEB_RAW_BODY is set, and body takes
+ *   each piece whole; without it they are collected as well, and onBody() passes the body in one piece. onBody()
+ *   leaves multipart bodies to the server there. The path must be exact, and both are called after begin().
+ */
+  void       onBody(const char* path, BodyFunction body, HandlerFunction complete);
+  void       onUpload(const char* path, FieldFunction field, HandlerFunction complete);
+
+/**
+ *   Serve PROGMEM content at path with an ETag validator and Cache-Control max-age. The ETag is computed from the 
+ *   content once, at registration, and a request whose If-None-Match matches it is answered with 304 Not Modified 
+ *   without sending the content. Call after begin().
+ */
+  void       serveStatic_P(const char* path, PGM_P contentType, PGM_P content)        {serveStatic_P(path,contentType,content,_cacheMaxAge);}
+  void       serveStatic_P(const char* path, PGM_P contentType, PGM_P content, unsigned long maxAge);
+
+/**
+ *   Serve a generated asset (see CommonAssets.h) the same way, sending its gzip form with Content-Encoding: gzip to
+ *   clients whose Accept-Encoding allows it. Each form has its own ETag, and responses carry Vary: Accept-Encoding.
+ *   send_P() sends an asset from a handler, negotiating the encoding when Accept-Encoding has been collected. Routes
+ *   in the response cache do not vary by encoding, so an asset route should not be cached.
+ */
+  void       serveStatic_P(const char* path, const ProgmemAsset& asset)               {serveStatic_P(path,asset,_cacheMaxAge);}
+  void       serveStatic_P(const char* path, const ProgmemAsset& asset, unsigned long maxAge);
+  void       send_P(int statusCode, const ProgmemAsset& asset);
+  void       setCacheMaxAge(unsigned long seconds)                                    {_cacheMaxAge = seconds;}
 
 #ifdef ESP8266
 
@@ -102,7 +414,6 @@ class WebContext {
      setClientHandler([this](){_server.handleClient();});
      setSendFunction([this](int status, const char* contentType, const char* content) {_server.send(status,contentType,content);});
      setSend_PFunction([this](int status, PGM_P contentType, PGM_P content) {_server.send_P(status,contentType,content);});
-     setOnFunction([this](const char* path, HandlerFunction f) {_server.on(path,[this,f](){f(this);});});
      setOnNotFoundFunction([this](HandlerFunction f) {_server.onNotFound([this,f](){f(this);});});
      setAddHandlerFunction([this](RequestHandler* h) {_server.addHandler(h);});
      setArgCountFunction([this]()->int{return _server.args();});
@@ -111,6 +422,12 @@ class WebContext {
      setURIFunction([this]()->const String&{_uri = _server.uri();return _uri;});
      setWiFiClientFunction([this]()->WiFiClient{return _server.client();});
      setCloseFunction([this](){_server.close();});
+     setContentLengthFunction([this](size_t len) {_server.setContentLength(len);});
+     setSendContentFunction([this](const char* content, size_t len) {_server.sendContent(content,len);});
+     setSendHeaderFunction([this](const char* name, const char* value) {_server.sendHeader(name,value);});
+     setCollectHeadersFunction([this](const char* names[], size_t count) {_server.collectHeaders(names,count);});
+     setHeaderFunction([this](const char* name)->const String&{return _server.header(name);});
+     setDetachFunction([this]()->WiFiClient{return _server.client();});
   }
 
 #elif defined(ESP32)
@@ -121,25 +438,76 @@ class WebContext {
      setClientHandler([this](){_server.handleClient();});
      setSendFunction([this](int status, const char* contentType, const char* content) {_server.send(status,contentType,content);});
      setSend_PFunction([this](int status, PGM_P contentType, PGM_P content) {_server.send_P(status,contentType,content);});
-     setOnFunction([this](const char* path, HandlerFunction f) {_server.on(path,[this,f](){f(this);});});
      setOnNotFoundFunction([this](HandlerFunction f) {_server.onNotFound([this,f](){f(this);});});
      setAddHandlerFunction([this](RequestHandler* h) {_server.addHandler(h);});
      setArgCountFunction([this]()->int{return _server.args();});
-     setArgFunction([this](int i)->const String&{this->argVal = _server.arg(i);return this->argVal;});
-     setArgNameFunction([this](int i)->const String&{this->argNam = _server.argName(i);return this->argNam;});
+     setArgFunction([this](int i)->const String&{return _server.argRef(i);});
+     setArgNameFunction([this](int i)->const String&{return _server.argNameRef(i);});
      setURIFunction([this]()->const String&{_uri = _server.uri();return _uri;});
      setWiFiClientFunction([this]()->WiFiClient{return _server.client();});
      setCloseFunction([this](){_server.close();});
+     setContentLengthFunction([this](size_t len) {_server.setContentLength(len);});
+     setSendContentFunction([this](const char* content, size_t len) {_server.sendContent(content,len);});
+     setSendHeaderFunction([this](const char* name, const char* value) {_server.sendHeader(name,value);});
+     setCollectHeadersFunction([this](const char* names[], size_t count) {_server.collectHeaders(names,count);});
+     setHeaderFunction([this](const char* name)->const String&{return _server.headerRef(name);});
+     setDetachFunction([this]()->WiFiClient{return _server.client();});
   }
   
+#elif defined(LSC_HOST)
+
+  void begin(int port=80) {
+     _server.begin(port);
+     _port = _server.port();
+     setClientHandler([this](){_server.handleClient();});
+     setSendFunction([this](int status, const char* contentType, const char* content) {_server.send(status,contentType,content);});
+     setSend_PFunction([this](int status, PGM_P contentType, PGM_P content) {_server.send_P(status,contentType,content);});
+     setOnNotFoundFunction([this](HandlerFunction f) {_server.onNotFound([this,f](){f(this);});});
+     setArgCountFunction([this]()->int{return _server.args();});
+     setArgFunction([this](int i)->const String&{return _server.arg(i);});
+     setArgNameFunction([this](int i)->const String&{return _server.argName(i);});
+     setURIFunction([this]()->const String&{return _server.uri();});
+     setWiFiClientFunction([this]()->WiFiClient{return _server.client();});
+     setCloseFunction([this](){_server.close();});
+     setContentLengthFunction([this](size_t len) {_server.setContentLength(len);});
+     setSendContentFunction([this](const char* content, size_t len) {_server.sendContent(content,len);});
+     setSendHeaderFunction([this](const char* name, const char* value) {_server.sendHeader(name,value);});
+     setCollectHeadersFunction([this](const char* names[], size_t count) {_server.collectHeaders(names,count);});
+     setHeaderFunction([this](const char* name)->const String&{return _server.header(name);});
+     setMaxConnectionsFunction([this](int n) {_server.setMaxConnections(n);});
+     setWorkersFunction([this](int n) {_server.setWorkers(n);});
+     setKeepAliveFunction([this](unsigned long timeout, int maxRequests) {_server.setKeepAlive(timeout,maxRequests);});
+     setConnectionStatsFunction([this]()->ConnectionStats {
+       ConnectionStats s;
+       s.accepted = _server.acceptedConnections();
+       s.requests = _server.servedRequests();
+       s.reused   = _server.reusedRequests();
+       return s;
+     });
+     _server.setAffinityFunction([this](const char* uri)->bool{return runsOnMainThread(uri);});
+     _server.setBodyHandler([this](const char* uri)->bool{return streamsBody(uri);},
+                            [this](const char* data, size_t len, size_t offset)->size_t{return streamBody(data,len,offset);});
+     setRequestStartFunction([this]()->unsigned long {return _server.requestStart();});
+     setParserFunction([this]()->const HttpParser* {return _server.parser();});
+     setDetachFunction([this]()->WiFiClient{return _server.detach();});
+  }
+
+/**
+ *   Replay a raw HTTP request through the registered handlers in-process, appending the full response to
+ *   response. Returns the HTTP status code sent, or 0 if no response was sent. See HostServer::inject().
+ */
+  int inject(const char* request, String& response)                                   {return _server.inject(request,response);}
+
 #endif
   
 /**
- *   Default handler functions do nothing
+ *   Default handler functions do nothing, except that those of serving modes the server lacks warn that the mode is
+ *   ignored
  */
   private:
   ClientHandler             _handleClient               = [](){};
-  URIFunction               _uriFunction                = []()->String{return _empty;};
+  URIFunction               _uriFunction                = []()->const String&{return _empty;};
+  ParserFunction            _parserFunction             = []()->const HttpParser*{return NULL;};
   SendFunction              _sendFunction               = [](int,const char*,const char*)->void{};
   Send_PFunction            _send_PFunction             = [](int,PGM_P,PGM_P)->void{};
   OnFunction                _onFunction                 = [](const char*,HandlerFunction)->void{};
@@ -150,19 +518,73 @@ class WebContext {
   ArgFunction               _argNameFunction            = [this](int)->const String&{return this->_empty;};
   WiFiClientFunction        _wifiClientFunction         = [this]()->WiFiClient{return _client;};
   CloseFunction             _closeFunction              = [](){};
+  ContentLengthFunction     _contentLengthFunction      = [](size_t){};
+  SendContentFunction       _sendContentFunction        = [](const char*,size_t){};
+  SendHeaderFunction        _sendHeaderFunction         = [](const char*,const char*){};
+  CollectHeadersFunction    _collectHeadersFunction     = [](const char*[],size_t){};
+  HeaderFunction            _headerFunction             = [this](const char*)->const String&{return this->_empty;};
+  MaxConnectionsFunction    _maxConnectionsFunction     = [](int n){if( n > 0 ) unsupported("setMaxConnections()");};
+  WorkersFunction           _workersFunction            = [](int n){if( n > 0 ) unsupported("setWorkers()");};
+  KeepAliveFunction         _keepAliveFunction          = [](unsigned long,int){};
+  ConnectionStatsFunction   _connectionStatsFunction    = []()->ConnectionStats {return ConnectionStats();};
+  RequestStartFunction      _requestStartFunction       = []()->unsigned long {return 0;};
+  DetachFunction            _detachFunction             = [this]()->WiFiClient{return client();};
   
   protected:
   static const String    _empty;
-  String                 argVal;
-  String                 argNam;
   String                _uri;
   WiFiClient            _client;
   int                   _port = 0;
+  const char*           _headerKeys[WEB_MAX_HEADERS];
+  size_t                _headerCount = 0;
+  unsigned long         _cacheMaxAge = WEB_CACHE_MAX_AGE;
+  RouteTable            _routes;
+  HandlerFunction*      _handlers = NULL;
+  struct RouteUpload;
+  struct RouteOptions {
+    bool                mainThread = false;
+    bool                cached     = false;
+    unsigned long       cacheTtl   = 0;
+    const char*         cacheTag   = NULL;
+    RouteMetrics*       metrics    = NULL;
+    HandlerProfile*     profile    = NULL;
+    BodyFunction        body       = NULL;
+    RouteUpload*        upload     = NULL;
+  };
+  void                  growRoutes(int route);
+  static void           unsupported(const char* mode);
+  bool                  streamsBody(const char* uri);
+  size_t                streamBody(const char* data, size_t len, size_t offset);
+  bool                  cacheKey(const String& uri, String& key);
+  void                  sendCached(const ResponseCache::Entry* e);
+  bool                  capturing() const                                             {return (_request != NULL) && (_request->capture != NULL);}
+  void                  noteSend(int status, const char* contentType, const char* content, bool progmem);
+  void                  noteContent(const char* content, size_t len);
+  void                  record(RouteMetrics* m, const RequestContext& r, unsigned long start);
+  void                  writeMetrics();
+  void                  invoke(HandlerFunction& f, HandlerProfile* profile);
+  void                  writeProfile();
+  RequestArena*         arena() const                                                 {return ((_request != NULL)?(_request->arena):(NULL));}
+
+  RouteOptions*         _options = NULL;
+  int                   _mainThreadRoutes = 0;
+  ResponseCache         _cache;
+  bool                  _metricsEnabled = false;
+  RouteMetrics*         _notFoundMetrics = NULL;
+  bool                  _profilingEnabled = false;
+  HandlerProfile*       _notFoundProfile = NULL;
+  RequestArena          _arenas[WEB_ARENAS];
+  int                   _handlerCapacity = 0;
+  HandlerFunction       _notFoundHandler = NULL;
+  EventChannel*         _channels = NULL;
+  static WEB_THREAD_LOCAL RequestContext* _request;
 
 #ifdef ESP8266
   ESP8266WebServer       _server;
 #elif defined(ESP32)
-  WebServer              _server;
+  ArgWebServer           _server;
+#elif defined(LSC_HOST)
+  HostServer             _server;
 #endif
   
 };
@@ -0,0 +1,93 @@
+/**
+ * 
+ *  CommonUtil Library
+ *  Copyright (C) 2023  Daniel L Toth
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published 
+ *  by the Free Software Foundation, either version 3 of the License, or any 
+ *  later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ *  
+ *  The author can be contacted at dan@leelanausoftware.com  
+ *
+ */
+
+
+/** WorkQueue is a bounded, lock-free, multi-producer multi-consumer FIFO of N slots (N a power of 2), after
+ *  Dmitry Vyukov's bounded MPMC queue. Each slot carries a sequence number that tells producers and consumers
+ *  whether it is free or full for their position, so push() and pop() each cost one compare and swap on the
+ *  tail or head and never block. Neither allocates, and both return false rather than wait when the queue is
+ *  full or empty; callers that need to sleep pair the queue with their own wakeup.
+ */
+
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <atomic>
+
+/** Leelanau Software Company namespace
+*
+*/
+namespace lsc {
+
+template<typename T, unsigned N>
+class WorkQueue {
+  static_assert((N >= 2) && ((N & (N-1)) == 0), "WorkQueue size must be a power of 2");
+
+  public:
+  WorkQueue()                                                    {for( unsigned i=0; i<N; i++ ) _cells[i].seq.store(i,std::memory_order_relaxed);}
+  WorkQueue(const WorkQueue&) = delete;
+  WorkQueue& operator=(const WorkQueue&) = delete;
+
+  bool push(const T& value) {
+    Cell*    cell;
+    unsigned pos = _tail.load(std::memory_order_relaxed);
+    for(;;) {
+      cell = &_cells[pos & (N-1)];
+      int diff = (int)(cell->seq.load(std::memory_order_acquire) - pos);
+      if( diff == 0 ) {if( _tail.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed) ) break;}
+      else if( diff < 0 ) return false;
+      else pos = _tail.load(std::memory_order_relaxed);
+    }
+    cell->value = value;
+    cell->seq.store(pos+1,std::memory_order_release);
+    return true;
+  }
+
+  bool pop(T& value) {
+    Cell*    cell;
+    unsigned pos = _head.load(std::memory_order_relaxed);
+    for(;;) {
+      cell = &_cells[pos & (N-1)];
+      int diff = (int)(cell->seq.load(std::memory_order_acquire) - (pos+1));
+      if( diff == 0 ) {if( _head.compare_exchange_weak(pos,pos+1,std::memory_order_relaxed) ) break;}
+      else if( diff < 0 ) return false;
+      else pos = _head.load(std::memory_order_relaxed);
+    }
+    value = cell->value;
+    cell->seq.store(pos+N,std::memory_order_release);
+    return true;
+  }
+
+  private:
+  struct Cell {
+    std::atomic<unsigned> seq;
+    T                     value;
+  };
+
+  Cell                  _cells[N];
+  std::atomic<unsigned> _head{0};
+  std::atomic<unsigned> _tail{0};
+};
+
+} // End of namespace lsc
+
+#endif